@@ -36,6 +36,10 @@ SOFTWARE.
 
 #include "6502.h"
 #include "memory.h"
+#include "apple2emu.h"
+#include "scheduler.h"
+#include "machine.h"
+#include "snapshot.h"
 
 cpu_6502::opcode_info cpu_6502::m_6502_opcodes[] = {
  // 0x00 - 0x0f
@@ -623,6 +627,30 @@ cpu_6502::opcode_info cpu_6502::m_65c02_opcodes[] = {
 };
 
 
+void cpu_6502::save_state(snapshot_writer &writer)
+{
+	writer.write(m_pc);
+	writer.write(m_sp);
+	writer.write(m_acc);
+	writer.write(m_xindex);
+	writer.write(m_yindex);
+	writer.write(m_status_register);
+}
+
+// the opcode tables aren't part of the state.  They come from the
+// machine type when the machine is reset
+void cpu_6502::load_state(snapshot_reader &reader)
+{
+	reader.read(m_pc);
+	reader.read(m_sp);
+	reader.read(m_acc);
+	reader.read(m_xindex);
+	reader.read(m_yindex);
+	reader.read(m_status_register);
+	m_extra_cycles = 0;
+	m_exit_requested = false;
+}
+
 void cpu_6502::init(cpu_6502::cpu_mode mode)
 {
 	m_pc = 0;
@@ -631,14 +659,17 @@ void cpu_6502::init(cpu_6502::cpu_mode mode)
 	m_yindex = 0xff;
 	m_acc = 0xff;
 	m_status_register = 0xff;
+	m_exit_requested = false;
 	set_flag(register_bit::DECIMAL_BIT, 0);
 	set_flag(register_bit::NOT_USED_BIT, 1);
 
 	// set the opcodes based on what cpu we are emulating
 	if (mode == cpu_6502::cpu_mode::CPU_6502) {
 		m_opcodes = m_6502_opcodes;
+		m_handlers = m_6502_handlers;
 	} else {
 		m_opcodes = m_65c02_opcodes;
+		m_handlers = m_65c02_handlers;
 	}
 
 	// start vector
@@ -815,666 +846,1321 @@ inline void cpu_6502::branch_relative()
 }
 
 //
-// main loop for opcode processing
+// opcode operations.  These are specialized with an addressing mode
+// through execute() below to build the per opcode handler tables
 //
-uint32_t cpu_6502::process_opcode()
+template<bool is_65c02> inline void cpu_6502::op_adc(uint16_t src)
 {
-	m_extra_cycles = 0;
+	uint8_t val = memory_read(src);
+	uint32_t carry_bit = get_flag(register_bit::CARRY_BIT);
+	uint32_t sum = (uint32_t)m_acc + (uint32_t)val + carry_bit;
+	if (get_flag(register_bit::DECIMAL_BIT)) {
+		// decimal mode - see http://www.6502.org/tutorials/decimal_mode.html#3.2.2
+		// for detailed information on BCD and flags.  One of the
+		// most trickieest parts of the opcode set
+
+		// set the zero bit flag for 6502 as it is based
+		// on the binary sum as done before the consitionals
+		set_flag(register_bit::ZERO_BIT, ((sum & 0xff) == 0));
+		set_flag(register_bit::OVERFLOW_BIT, ~(m_acc ^ val) & (m_acc ^ sum) & 0x80);
+
+		int32_t al = (m_acc & 0xf) + (val & 0xf) + carry_bit;
+		if (al >= 0x0a) {
+			al = ((al + 0x06) & 0x0f) + 0x10;
+		}
+		sum = (m_acc & 0xf0) + (val & 0xf0) + al;
+		set_flag(register_bit::SIGN_BIT, (sum & 0x80));
 
-	// get the opcode at the program counter and the just figure out what
-	// to do
-	uint8_t opcode = memory_read(m_pc++, true);
+		if (sum >= 0xa0) {
+			sum += 0x60;
+		}
+		set_flag(register_bit::CARRY_BIT, (sum >= 0x100));
 
-	// get addressing mode and then do appropriate work based on the mode
-	addr_mode mode = m_opcodes[opcode].m_addr_mode;
-	SDL_assert(mode != addr_mode::NO_MODE);
-	SDL_assert(m_opcodes[opcode].m_cycle_count != 0);
-	SDL_assert(m_opcodes[opcode].m_addr_func != nullptr);
-	uint16_t src = (this->*m_opcodes[opcode].m_addr_func)();
-
-	uint8_t cycles = m_opcodes[opcode].m_cycle_count;
-
-	// execute the actual opcode
-	switch (m_opcodes[opcode].m_mnemonic) {
-	case 'ADC ':
-	{
-		uint8_t val = memory_read(src);
-		uint32_t carry_bit = get_flag(register_bit::CARRY_BIT);
-		uint32_t sum = (uint32_t)m_acc + (uint32_t)val + carry_bit;
-		if (get_flag(register_bit::DECIMAL_BIT)) {
-			// decimal mode - see http://www.6502.org/tutorials/decimal_mode.html#3.2.2
-			// for detailed information on BCD and flags.  One of the
-			// most trickieest parts of the opcode set
-
-			// set the zero bit flag for 6502 as it is based
-			// on the binary sum as done before the consitionals
+		m_acc = sum & 0xff;
+
+		// sign bit is different on 6502 and 65c02
+		if (is_65c02) {
 			set_flag(register_bit::ZERO_BIT, ((sum & 0xff) == 0));
-			set_flag(register_bit::OVERFLOW_BIT, ~(m_acc ^ val) & (m_acc ^ sum) & 0x80);
+			set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
+			set_flag(register_bit::OVERFLOW_BIT, (sum >= 128));
+		}
+	} else {
+		set_flag(register_bit::CARRY_BIT, sum > 0xff);
+		set_flag(register_bit::OVERFLOW_BIT, ~(m_acc ^ val) & (m_acc ^ sum) & 0x80);
+		m_acc = sum & 0xff;
+		set_flag(register_bit::ZERO_BIT, (m_acc == 0));
+		set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
+	}
+}
 
-			int32_t al = (m_acc & 0xf) + (val & 0xf) + carry_bit;
-			if (al >= 0x0a) {
-				al = ((al + 0x06) & 0x0f) + 0x10;
-			}
-			sum = (m_acc & 0xf0) + (val & 0xf0) + al;
-			set_flag(register_bit::SIGN_BIT, (sum & 0x80));
+inline void cpu_6502::op_and(uint16_t src)
+{
+	m_acc &= memory_read(src);
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7));
+	set_flag(register_bit::ZERO_BIT, (m_acc == 0));
+}
 
-			if (sum >= 0xa0) {
-				sum += 0x60;
-			}
-			set_flag(register_bit::CARRY_BIT, (sum >= 0x100));
+inline void cpu_6502::op_asl(uint16_t src)
+{
+	uint8_t old_val = memory_read(src);
+	uint8_t val = old_val << 1;
+	memory_write(src, val);
+	set_flag(register_bit::SIGN_BIT, val >> 7);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+	set_flag(register_bit::CARRY_BIT, old_val >> 7);
+}
 
-			m_acc = sum & 0xff;
+inline void cpu_6502::op_asl_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	uint8_t old_val = m_acc;
+	uint8_t val = old_val << 1;
+	m_acc = val;
+	set_flag(register_bit::SIGN_BIT, val >> 7);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+	set_flag(register_bit::CARRY_BIT, old_val >> 7);
+}
 
-			// sign bit is different on 6502 and 65c02
-			if (m_opcodes == m_65c02_opcodes) {
-				set_flag(register_bit::ZERO_BIT, ((sum & 0xff) == 0));
-				set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
-				set_flag(register_bit::OVERFLOW_BIT, (sum >= 128));
-			}
-		} else {
-			set_flag(register_bit::CARRY_BIT, sum > 0xff);
-			set_flag(register_bit::OVERFLOW_BIT, ~(m_acc ^ val) & (m_acc ^ sum) & 0x80);
-			m_acc = sum & 0xff;
-			set_flag(register_bit::ZERO_BIT, (m_acc == 0));
-			set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
-		}
-		break;
+inline void cpu_6502::op_bcc(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::CARRY_BIT) == 0) {
+		branch_relative();
 	}
+}
 
-	case 'AND ':
-	{
-		m_acc &= memory_read(src);
-		set_flag(register_bit::SIGN_BIT, (m_acc >> 7));
-		set_flag(register_bit::ZERO_BIT, (m_acc == 0));
-		break;
+inline void cpu_6502::op_bcs(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::CARRY_BIT) == 1) {
+		branch_relative();
 	}
+}
 
-	case 'ASL ':
-	{
-		uint8_t val, old_val;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			old_val = m_acc;
-		}
-		else {
-			old_val = memory_read(src);
-		}
-		val = old_val << 1;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			m_acc = val;
-		}
-		else {
-			memory_write(src, val);
-		}
-		set_flag(register_bit::SIGN_BIT, val >> 7);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		set_flag(register_bit::CARRY_BIT, old_val >> 7);
-		break;
+inline void cpu_6502::op_beq(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::ZERO_BIT) == 1) {
+		branch_relative();
 	}
+}
 
-	case 'BCC ':
-	{
-		if (get_flag(register_bit::CARRY_BIT) == 0) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BCS ':
-	{
-		if (get_flag(register_bit::CARRY_BIT) == 1) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BEQ ':
-	{
-		if (get_flag(register_bit::ZERO_BIT) == 1) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BIT ':
-	{
-		int8_t val = memory_read(src);
-		set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
-
-		// immediate mode with BIT only sets the zero flag
-		if (mode != cpu_6502::addr_mode::IMMEDIATE_MODE) {
-			set_flag(register_bit::SIGN_BIT, ((val >> 7) & 0x1));
-			set_flag(register_bit::OVERFLOW_BIT, ((val >> 6) & 0x1));
-		}
-		break;
-	}
-	case 'BMI ':
-	{
-		if (get_flag(register_bit::SIGN_BIT) == 1) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BNE ':
-	{
-		if (get_flag(register_bit::ZERO_BIT) == 0) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BPL ':
-	{
-		if (get_flag(register_bit::SIGN_BIT) == 0) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BRA ':
-	{
+inline void cpu_6502::op_bit(uint16_t src)
+{
+	int8_t val = memory_read(src);
+	set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
+	set_flag(register_bit::SIGN_BIT, ((val >> 7) & 0x1));
+	set_flag(register_bit::OVERFLOW_BIT, ((val >> 6) & 0x1));
+}
+
+inline void cpu_6502::op_bit_immediate(uint16_t src)
+{
+	// immediate mode with BIT only sets the zero flag
+	int8_t val = memory_read(src);
+	set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
+}
+
+inline void cpu_6502::op_bmi(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::SIGN_BIT) == 1) {
 		branch_relative();
-		break;
 	}
-	case 'BRK ':
-	{
-		m_pc++;
-		memory_write(0x100 + m_sp--, (m_pc >> 8));
-		memory_write(0x100 + m_sp--, (m_pc & 0xff));
-		uint8_t register_value = m_status_register;
-		register_value |= (1 << static_cast<uint8_t>(register_bit::NOT_USED_BIT));
-		register_value |= (1 << static_cast<uint8_t>(register_bit::BREAK_BIT));
-		memory_write(0x100 + m_sp--, register_value);
-		set_flag(register_bit::INTERRUPT_BIT, 1);
-		if (m_opcodes == m_65c02_opcodes) {
-			set_flag(register_bit::DECIMAL_BIT, 0);
-		}
+}
 
-		// clear decimal flag on break
-		m_pc = (memory_read(0xfffe) & 0xff) | (memory_read(0xffff) << 8);
-		break;
-	}
-	case 'BVC ':
-	{
-		if (get_flag(register_bit::OVERFLOW_BIT) == 0) {
-			branch_relative();
-		}
-		break;
-	}
-	case 'BVS ':
-	{
-		if (get_flag(register_bit::OVERFLOW_BIT) == 1) {
-			branch_relative();
-		}
-		break;
+inline void cpu_6502::op_bne(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::ZERO_BIT) == 0) {
+		branch_relative();
 	}
-	case 'CLC ':
-	{
-		set_flag(register_bit::CARRY_BIT, 0);
-		break;
+}
+
+inline void cpu_6502::op_bpl(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::SIGN_BIT) == 0) {
+		branch_relative();
 	}
-	case 'CLD ':
-	{
+}
+
+inline void cpu_6502::op_bra(uint16_t src)
+{
+	UNREFERENCED(src);
+	branch_relative();
+}
+
+template<bool is_65c02> inline void cpu_6502::op_brk(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_pc++;
+	memory_write(0x100 + m_sp--, (m_pc >> 8));
+	memory_write(0x100 + m_sp--, (m_pc & 0xff));
+	uint8_t register_value = m_status_register;
+	register_value |= (1 << static_cast<uint8_t>(register_bit::NOT_USED_BIT));
+	register_value |= (1 << static_cast<uint8_t>(register_bit::BREAK_BIT));
+	memory_write(0x100 + m_sp--, register_value);
+	set_flag(register_bit::INTERRUPT_BIT, 1);
+
+	// clear decimal flag on break
+	if (is_65c02) {
 		set_flag(register_bit::DECIMAL_BIT, 0);
-		break;
-	}
-	case 'CLI ':
-	{
-		set_flag(register_bit::INTERRUPT_BIT, 0);
-		break;
-	}
-	case 'CLV ':
-	{
-		set_flag(register_bit::OVERFLOW_BIT, 0);
-		break;
-	}
-	case 'CMP ':
-	{
-		uint8_t src_val = memory_read(src);
-		if (m_acc >= src_val) {
-			set_flag(register_bit::CARRY_BIT, 1);
-		}
-		else {
-			set_flag(register_bit::CARRY_BIT, 0);
-		}
-		int8_t val = m_acc - src_val;
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
-	}
-	case 'CPX ':
-	{
-		uint8_t src_val = memory_read(src);
-		if (m_xindex >= src_val) {
-			set_flag(register_bit::CARRY_BIT, 1);
-		}
-		else {
-			set_flag(register_bit::CARRY_BIT, 0);
-		}
-		int8_t val = m_xindex - src_val;
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
 	}
-	case 'CPY ':
-	{
-		uint8_t src_val = memory_read(src);
-		if (m_yindex >= src_val) {
-			set_flag(register_bit::CARRY_BIT, 1);
-		}
-		else {
-			set_flag(register_bit::CARRY_BIT, 0);
-		}
-		int8_t val = m_yindex - src_val;
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
-	}
-	case 'DEC ':
-	{
-		uint8_t val;
-		if (mode == cpu_6502::addr_mode::ACCUMULATOR_MODE) {
-			m_acc--;
-			val = m_acc;
-		} else {
-			val = memory_read(src) - 1;
-			memory_write(src, val);
-		}
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
-	}
-	case 'DEX ':
-	{
-		m_xindex--;
-		set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
-		break;
-	}
-	case 'DEY ':
-	{
-		m_yindex--;
-		set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
-		break;
-	}
-	case 'EOR ':
-	{
-		uint8_t val = memory_read(src);
-		m_acc ^= val;
-		set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_acc == 0) & 0x1);
-		break;
-	}
-	case 'INC ':
-	{
-		uint8_t val;
-		if (mode == cpu_6502::addr_mode::ACCUMULATOR_MODE) {
-			m_acc++;
-			val = m_acc;
-		} else {
-			val = memory_read(src) + 1;
-			memory_write(src, val);
-		}
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
-	}
-	break;
-	case 'INX ':
-	{
-		m_xindex++;
-		set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
-		break;
-	}
-	case 'INY ':
-	{
-		m_yindex++;
-		set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
-		break;
+
+	m_pc = (memory_read(0xfffe) & 0xff) | (memory_read(0xffff) << 8);
+}
+
+inline void cpu_6502::op_bvc(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::OVERFLOW_BIT) == 0) {
+		branch_relative();
 	}
-	case 'JMP ':
-	{
-		m_pc = src;
-		break;
+}
+
+inline void cpu_6502::op_bvs(uint16_t src)
+{
+	UNREFERENCED(src);
+	if (get_flag(register_bit::OVERFLOW_BIT) == 1) {
+		branch_relative();
 	}
-	case 'JSR ':
-	{
+}
+
+inline void cpu_6502::op_clc(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::CARRY_BIT, 0);
+}
+
+inline void cpu_6502::op_cld(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::DECIMAL_BIT, 0);
+}
+
+inline void cpu_6502::op_cli(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::INTERRUPT_BIT, 0);
+}
+
+inline void cpu_6502::op_clv(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::OVERFLOW_BIT, 0);
+}
+
+inline void cpu_6502::op_cmp(uint16_t src)
+{
+	uint8_t src_val = memory_read(src);
+	set_flag(register_bit::CARRY_BIT, m_acc >= src_val);
+	int8_t val = m_acc - src_val;
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_cpx(uint16_t src)
+{
+	uint8_t src_val = memory_read(src);
+	set_flag(register_bit::CARRY_BIT, m_xindex >= src_val);
+	int8_t val = m_xindex - src_val;
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_cpy(uint16_t src)
+{
+	uint8_t src_val = memory_read(src);
+	set_flag(register_bit::CARRY_BIT, m_yindex >= src_val);
+	int8_t val = m_yindex - src_val;
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_dec(uint16_t src)
+{
+	uint8_t val = memory_read(src) - 1;
+	memory_write(src, val);
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_dec_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_acc--;
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_dex(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_xindex--;
+	set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_dey(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_yindex--;
+	set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_eor(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	m_acc ^= val;
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_acc == 0) & 0x1);
+}
+
+inline void cpu_6502::op_inc(uint16_t src)
+{
+	uint8_t val = memory_read(src) + 1;
+	memory_write(src, val);
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_inc_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_acc++;
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_inx(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_xindex++;
+	set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_iny(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_yindex++;
+	set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_jmp(uint16_t src)
+{
+	m_pc = src;
+}
+
+inline void cpu_6502::op_jsr(uint16_t src)
+{
 #if defined(FUNCTIONAL_TESTS)
-		if (src == 0xf001) {
-			debugger_print_char_to_console(m_acc);
-		}
-		else if (src == 0xf004) {
-//			m_acc = _getch();
-//		} else if (src == 0x43bf) {
-			//debug_break();
-		} else {
-			memory_write(0x100 + m_sp--, ((m_pc - 1) >> 8));
-			memory_write(0x100 + m_sp--, (m_pc - 1) & 0xff);
-			m_pc = src;
-		}
-#else
+	if (src == 0xf001) {
+		debugger_print_char_to_console(m_acc);
+	}
+	else if (src == 0xf004) {
+//		m_acc = _getch();
+//	} else if (src == 0x43bf) {
+		//debug_break();
+	} else {
 		memory_write(0x100 + m_sp--, ((m_pc - 1) >> 8));
 		memory_write(0x100 + m_sp--, (m_pc - 1) & 0xff);
 		m_pc = src;
-#endif
-		break;
-	}
-	case 'LDA ':
-	{
-		m_acc = memory_read(src);
-		set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_acc == 0) & 0x1);
-		break;
-	}
-	case 'LDX ':
-	{
-		m_xindex = memory_read(src);
-		set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
-		break;
-	}
-	case 'LDY ':
-	{
-		m_yindex = memory_read(src);
-		set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
-		break;
-	}
-	case 'LSR ':
-	{
-		uint8_t val;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			val = m_acc;
-		}
-		else {
-			val = memory_read(src);
-		}
-		set_flag(register_bit::CARRY_BIT, val & 1);
-		val >>= 1;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			m_acc = val;
-		}
-		else {
-			memory_write(src, val);
-		}
-		set_flag(register_bit::SIGN_BIT, 0);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		break;
-	}
-	case 'NOP ':
-	{
-		break;
-	}
-	case 'ORA ':
-	{
-		uint8_t val = memory_read(src);
-		m_acc |= val;
-		set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, m_acc == 0);
-		break;
-	}
-	case 'PHA ':
-	{
-		memory_write(0x100 + m_sp--, m_acc);
-		break;
-	}
-	case 'PHX ':
-	{
-		memory_write(0x100 + m_sp--, m_xindex);
-		break;
-	}
-	case 'PHY ':
-	{
-		memory_write(0x100 + m_sp--, m_yindex);
-		break;
-	}
-	case 'PLA ':
-	{
-		m_acc = memory_read(0x100 + ++m_sp);
-		set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, m_acc == 0);
-		break;
-	}
-	case 'PLX ':
-	{
-		m_xindex = memory_read(0x100 + ++m_sp);
-		set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, m_xindex == 0);
-		break;
 	}
-	case 'PLY ':
-	{
-		m_yindex = memory_read(0x100 + ++m_sp);
-		set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, m_yindex == 0);
-		break;
-	}
-	case 'PHP ':
-	{
-		uint8_t register_value = m_status_register;
-		register_value |= 1 << (static_cast<uint8_t>(register_bit::BREAK_BIT));
-		register_value |= 1 << (static_cast<uint8_t>(register_bit::NOT_USED_BIT));
-		memory_write(0x100 + m_sp--, register_value);
-		break;
-	}
-	case 'PLP ':
-	{
-		m_status_register = memory_read(0x100 + ++m_sp);
-		break;
-	}
-	case 'ROL ':
-	{
-		uint8_t val;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			val = m_acc;
-		}
-		else {
-			val = memory_read(src);
-		}
-		uint8_t carry_bit = (val >> 7) & 0x1;
-		val <<= 1;
-		val |= get_flag(register_bit::CARRY_BIT);
-		set_flag(register_bit::CARRY_BIT, carry_bit);
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			m_acc = val;
-		}
-		else {
-			memory_write(src, val);
-		}
-		break;
-	}
-	case 'ROR ':
-	{
-		uint8_t val;
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			val = m_acc;
-		}
-		else {
-			val = memory_read(src);
-		}
-		uint8_t carry_bit = val & 0x1;
-		val >>= 1;
-		val |= (get_flag(register_bit::CARRY_BIT) & 0x1) << 7;
-		set_flag(register_bit::CARRY_BIT, carry_bit);
-		set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
-		set_flag(register_bit::ZERO_BIT, val == 0);
-		if (mode == addr_mode::ACCUMULATOR_MODE) {
-			m_acc = val;
-		}
-		else {
-			memory_write(src, val);
-		}
-		break;
-	}
-	case 'RTI ':
-	{
-		m_status_register = memory_read(0x100 + ++m_sp);
-		m_pc = memory_read(0x100 + ++m_sp);
-		m_pc = (memory_read(0x100 + ++m_sp) << 8) | m_pc;
-		break;
-	}
-	case 'RTS ':
-	{
-		uint16_t addr = memory_read(0x100 + ++m_sp) & 0x00ff;
-		addr |= (memory_read(0x100 + ++m_sp) << 8);
-		m_pc = addr;
-		m_pc++;
-		break;
-	}
-	case 'SBC ':
-	{
-		uint8_t val = memory_read(src);
-		int32_t sum;
-		uint32_t carry_bit = get_flag(register_bit::CARRY_BIT);
-		sum = m_acc + (~val & 0xff) + carry_bit;
-		if (get_flag(register_bit::DECIMAL_BIT)) {
-			// decimal mode.
-
-			// behavior of ADC is slightly different on 6502 and 65c02.
-			// just split it out into separate conditionals to make code
-			// easier to understand
-			if (m_opcodes == m_6502_opcodes) {
-				set_flag(register_bit::CARRY_BIT, sum > 0xff);
-				set_flag(register_bit::OVERFLOW_BIT, (m_acc ^ val) & (m_acc ^ sum) & 0x80);
-				int32_t al = (m_acc & 0x0f) - (val & 0x0f) + carry_bit - 1;
-				if (al < 0) {
-					al = ((al - 0x06) & 0x0f) - 0x10;
-				}
-				sum = (m_acc & 0xf0) - (val & 0xf0) + al;
-				if (sum < 0) {
-					sum = sum - 0x60;
-				}
-				m_acc = sum & 0xff;
-
-				// flags are set as they are in binary arithmetic mode
-				set_flag(register_bit::ZERO_BIT, (m_acc == 0));
-				set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
-			} else {
-				set_flag(register_bit::CARRY_BIT, sum > 0xff);
-				set_flag(register_bit::OVERFLOW_BIT, (m_acc ^ val) & (m_acc ^ sum) & 0x80);
-				int32_t al = (m_acc & 0x0f) - (val & 0x0f) + carry_bit - 1;
-				sum = m_acc - val + carry_bit - 1;
-				if (sum < 0) {
-					sum = sum - 0x60;
-				}
-				if (al < 0) {
-					sum = sum - 0x06;
-				}
-				m_acc = sum & 0xff;
-
-				// flags are set as they are in binary arithmetic mode
-				set_flag(register_bit::ZERO_BIT, (m_acc == 0));
-				set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
+#else
+	memory_write(0x100 + m_sp--, ((m_pc - 1) >> 8));
+	memory_write(0x100 + m_sp--, (m_pc - 1) & 0xff);
+	m_pc = src;
+#endif
+}
+
+inline void cpu_6502::op_lda(uint16_t src)
+{
+	m_acc = memory_read(src);
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_acc == 0) & 0x1);
+}
+
+inline void cpu_6502::op_ldx(uint16_t src)
+{
+	m_xindex = memory_read(src);
+	set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_xindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_ldy(uint16_t src)
+{
+	m_yindex = memory_read(src);
+	set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, (m_yindex == 0) & 0x1);
+}
+
+inline void cpu_6502::op_lsr(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	set_flag(register_bit::CARRY_BIT, val & 1);
+	val >>= 1;
+	memory_write(src, val);
+	set_flag(register_bit::SIGN_BIT, 0);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+}
+
+inline void cpu_6502::op_lsr_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::CARRY_BIT, m_acc & 1);
+	m_acc >>= 1;
+	set_flag(register_bit::SIGN_BIT, 0);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_nop(uint16_t src)
+{
+	UNREFERENCED(src);
+}
+
+inline void cpu_6502::op_ora(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	m_acc |= val;
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_pha(uint16_t src)
+{
+	UNREFERENCED(src);
+	memory_write(0x100 + m_sp--, m_acc);
+}
+
+inline void cpu_6502::op_phx(uint16_t src)
+{
+	UNREFERENCED(src);
+	memory_write(0x100 + m_sp--, m_xindex);
+}
+
+inline void cpu_6502::op_phy(uint16_t src)
+{
+	UNREFERENCED(src);
+	memory_write(0x100 + m_sp--, m_yindex);
+}
+
+inline void cpu_6502::op_pla(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_acc = memory_read(0x100 + ++m_sp);
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_plx(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_xindex = memory_read(0x100 + ++m_sp);
+	set_flag(register_bit::SIGN_BIT, (m_xindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_xindex == 0);
+}
+
+inline void cpu_6502::op_ply(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_yindex = memory_read(0x100 + ++m_sp);
+	set_flag(register_bit::SIGN_BIT, (m_yindex >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_yindex == 0);
+}
+
+inline void cpu_6502::op_php(uint16_t src)
+{
+	UNREFERENCED(src);
+	uint8_t register_value = m_status_register;
+	register_value |= 1 << (static_cast<uint8_t>(register_bit::BREAK_BIT));
+	register_value |= 1 << (static_cast<uint8_t>(register_bit::NOT_USED_BIT));
+	memory_write(0x100 + m_sp--, register_value);
+}
+
+inline void cpu_6502::op_plp(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_status_register = memory_read(0x100 + ++m_sp);
+}
+
+inline void cpu_6502::op_rol(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	uint8_t carry_bit = (val >> 7) & 0x1;
+	val <<= 1;
+	val |= get_flag(register_bit::CARRY_BIT);
+	set_flag(register_bit::CARRY_BIT, carry_bit);
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+	memory_write(src, val);
+}
+
+inline void cpu_6502::op_rol_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	uint8_t carry_bit = (m_acc >> 7) & 0x1;
+	m_acc <<= 1;
+	m_acc |= get_flag(register_bit::CARRY_BIT);
+	set_flag(register_bit::CARRY_BIT, carry_bit);
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_ror(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	uint8_t carry_bit = val & 0x1;
+	val >>= 1;
+	val |= (get_flag(register_bit::CARRY_BIT) & 0x1) << 7;
+	set_flag(register_bit::CARRY_BIT, carry_bit);
+	set_flag(register_bit::SIGN_BIT, (val >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, val == 0);
+	memory_write(src, val);
+}
+
+inline void cpu_6502::op_ror_acc(uint16_t src)
+{
+	UNREFERENCED(src);
+	uint8_t carry_bit = m_acc & 0x1;
+	m_acc >>= 1;
+	m_acc |= (get_flag(register_bit::CARRY_BIT) & 0x1) << 7;
+	set_flag(register_bit::CARRY_BIT, carry_bit);
+	set_flag(register_bit::SIGN_BIT, (m_acc >> 7) & 0x1);
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+}
+
+inline void cpu_6502::op_rti(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_status_register = memory_read(0x100 + ++m_sp);
+	m_pc = memory_read(0x100 + ++m_sp);
+	m_pc = (memory_read(0x100 + ++m_sp) << 8) | m_pc;
+}
+
+inline void cpu_6502::op_rts(uint16_t src)
+{
+	UNREFERENCED(src);
+	uint16_t addr = memory_read(0x100 + ++m_sp) & 0x00ff;
+	addr |= (memory_read(0x100 + ++m_sp) << 8);
+	m_pc = addr;
+	m_pc++;
+}
+
+template<bool is_65c02> inline void cpu_6502::op_sbc(uint16_t src)
+{
+	uint8_t val = memory_read(src);
+	int32_t sum;
+	uint32_t carry_bit = get_flag(register_bit::CARRY_BIT);
+	sum = m_acc + (~val & 0xff) + carry_bit;
+	if (get_flag(register_bit::DECIMAL_BIT)) {
+		// decimal mode.
+
+		// behavior of ADC is slightly different on 6502 and 65c02.
+		// just split it out into separate conditionals to make code
+		// easier to understand
+		if (!is_65c02) {
+			set_flag(register_bit::CARRY_BIT, sum > 0xff);
+			set_flag(register_bit::OVERFLOW_BIT, (m_acc ^ val) & (m_acc ^ sum) & 0x80);
+			int32_t al = (m_acc & 0x0f) - (val & 0x0f) + carry_bit - 1;
+			if (al < 0) {
+				al = ((al - 0x06) & 0x0f) - 0x10;
+			}
+			sum = (m_acc & 0xf0) - (val & 0xf0) + al;
+			if (sum < 0) {
+				sum = sum - 0x60;
 			}
+			m_acc = sum & 0xff;
+
+			// flags are set as they are in binary arithmetic mode
+			set_flag(register_bit::ZERO_BIT, (m_acc == 0));
+			set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
 		} else {
 			set_flag(register_bit::CARRY_BIT, sum > 0xff);
 			set_flag(register_bit::OVERFLOW_BIT, (m_acc ^ val) & (m_acc ^ sum) & 0x80);
+			int32_t al = (m_acc & 0x0f) - (val & 0x0f) + carry_bit - 1;
+			sum = m_acc - val + carry_bit - 1;
+			if (sum < 0) {
+				sum = sum - 0x60;
+			}
+			if (al < 0) {
+				sum = sum - 0x06;
+			}
 			m_acc = sum & 0xff;
+
+			// flags are set as they are in binary arithmetic mode
 			set_flag(register_bit::ZERO_BIT, (m_acc == 0));
 			set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
 		}
-		break;
-	}
-	case 'SEC ':
-	{
-		set_flag(register_bit::CARRY_BIT, 1);
-		break;
-	}
-	case 'SED ':
-	{
-		set_flag(register_bit::DECIMAL_BIT, 1);
-		break;
-	}
-	case 'SEI ':
-	{
-		set_flag(register_bit::INTERRUPT_BIT, 1);
-		break;
-	}
-	case 'STA ':
-	{
-		memory_write(src, m_acc);
-		break;
-	}
-	case 'STX ':
-	{
-		memory_write(src, m_xindex);
-		break;
-	}
-	case 'STY ':
-	{
-		memory_write(src, m_yindex);
-		break;
-	}
-	case 'STZ ':
-	{
-		memory_write(src, 0);
-		break;
-	}
-	case 'TAX ':
-	{
-		m_xindex = m_acc;
-		set_flag(register_bit::ZERO_BIT, m_xindex == 0);
-		set_flag(register_bit::SIGN_BIT, m_xindex & 0x80);
-		break;
-	}
-	case 'TRB ':
-	{
-		int8_t val = memory_read(src);
-		set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
-
-		// switch bits in accum
-		memory_write(src, (~m_acc) & val);
-		break;
-	}
-	case 'TSB ':
-	{
-		int8_t val = memory_read(src);
-		set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
-
-		// switch bits in accum
-		memory_write(src, m_acc | val);
-		break;
-	}
-	case 'TXA ':
-	{
-		m_acc = m_xindex;
-		set_flag(register_bit::ZERO_BIT, m_acc == 0);
-		set_flag(register_bit::SIGN_BIT, m_acc & 0x80);
-		break;
-	}
-	case 'TAY ':
-	{
-		m_yindex = m_acc;
-		set_flag(register_bit::ZERO_BIT, m_yindex == 0);
-		set_flag(register_bit::SIGN_BIT, m_yindex & 0x80);
-		break;
-	}
-	case 'TYA ':
-	{
-		m_acc = m_yindex;
-		set_flag(register_bit::ZERO_BIT, m_acc == 0);
-		set_flag(register_bit::SIGN_BIT, m_acc & 0x80);
-		break;
-	}
-	case 'TXS ':
-	{
-		m_sp = m_xindex;
-		break;
-	}
-	case 'TSX ':
-	{
-		m_xindex = (int8_t)m_sp;
-		set_flag(register_bit::ZERO_BIT, m_xindex == 0);
-		set_flag(register_bit::SIGN_BIT, m_xindex & 0x80);
-		break;
+	} else {
+		set_flag(register_bit::CARRY_BIT, sum > 0xff);
+		set_flag(register_bit::OVERFLOW_BIT, (m_acc ^ val) & (m_acc ^ sum) & 0x80);
+		m_acc = sum & 0xff;
+		set_flag(register_bit::ZERO_BIT, (m_acc == 0));
+		set_flag(register_bit::SIGN_BIT, (m_acc & 0x80));
 	}
+}
 
-	default:
-	{
-		SDL_assert(0);
-	}
-	}
+inline void cpu_6502::op_sec(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::CARRY_BIT, 1);
+}
+
+inline void cpu_6502::op_sed(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::DECIMAL_BIT, 1);
+}
+
+inline void cpu_6502::op_sei(uint16_t src)
+{
+	UNREFERENCED(src);
+	set_flag(register_bit::INTERRUPT_BIT, 1);
+}
+
+inline void cpu_6502::op_sta(uint16_t src)
+{
+	memory_write(src, m_acc);
+}
+
+inline void cpu_6502::op_stx(uint16_t src)
+{
+	memory_write(src, m_xindex);
+}
+
+inline void cpu_6502::op_sty(uint16_t src)
+{
+	memory_write(src, m_yindex);
+}
+
+inline void cpu_6502::op_stz(uint16_t src)
+{
+	memory_write(src, 0);
+}
+
+inline void cpu_6502::op_tax(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_xindex = m_acc;
+	set_flag(register_bit::ZERO_BIT, m_xindex == 0);
+	set_flag(register_bit::SIGN_BIT, m_xindex & 0x80);
+}
+
+inline void cpu_6502::op_trb(uint16_t src)
+{
+	int8_t val = memory_read(src);
+	set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
+
+	// switch bits in accum
+	memory_write(src, (~m_acc) & val);
+}
+
+inline void cpu_6502::op_tsb(uint16_t src)
+{
+	int8_t val = memory_read(src);
+	set_flag(register_bit::ZERO_BIT, ((val & m_acc) == 0));
+
+	// switch bits in accum
+	memory_write(src, m_acc | val);
+}
+
+inline void cpu_6502::op_txa(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_acc = m_xindex;
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+	set_flag(register_bit::SIGN_BIT, m_acc & 0x80);
+}
+
+inline void cpu_6502::op_tay(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_yindex = m_acc;
+	set_flag(register_bit::ZERO_BIT, m_yindex == 0);
+	set_flag(register_bit::SIGN_BIT, m_yindex & 0x80);
+}
 
-	// return the number of cycles that we executed
-	return cycles + m_extra_cycles;
+inline void cpu_6502::op_tya(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_acc = m_yindex;
+	set_flag(register_bit::ZERO_BIT, m_acc == 0);
+	set_flag(register_bit::SIGN_BIT, m_acc & 0x80);
 }
 
+inline void cpu_6502::op_txs(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_sp = m_xindex;
+}
+
+inline void cpu_6502::op_tsx(uint16_t src)
+{
+	UNREFERENCED(src);
+	m_xindex = (int8_t)m_sp;
+	set_flag(register_bit::ZERO_BIT, m_xindex == 0);
+	set_flag(register_bit::SIGN_BIT, m_xindex & 0x80);
+}
+
+inline void cpu_6502::op_illegal(uint16_t src)
+{
+	UNREFERENCED(src);
+	SDL_assert(0);
+}
+
+//
+// glue an operation to its addressing mode.  Both are compile time
+// constants, so each instantiation is a single straight line handler
+//
+template<cpu_6502::op_func OP, cpu_6502::addr_func ADDR> void cpu_6502::execute(cpu_6502 *cpu)
+{
+	uint16_t src = (cpu->*ADDR)();
+	(cpu->*OP)(src);
+}
+
+cpu_6502::opcode_handler cpu_6502::m_6502_handlers[] = {
+ // 0x00 - 0x0f
+ &cpu_6502::execute<&cpu_6502::op_brk<false>, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsb, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_php, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsb, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x10 - 0x1f
+ &cpu_6502::execute<&cpu_6502::op_bpl, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_clc, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x20 - 0x2f
+ &cpu_6502::execute<&cpu_6502::op_jsr, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_plp, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x30 - 0x3f
+ &cpu_6502::execute<&cpu_6502::op_bmi, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sec, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x40 - 0x4f
+ &cpu_6502::execute<&cpu_6502::op_rti, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_pha, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_jmp, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x50 - 0x5f
+ &cpu_6502::execute<&cpu_6502::op_bvc, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cli, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x60 - 0x6f
+ &cpu_6502::execute<&cpu_6502::op_rts, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_pla, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_jmp, &cpu_6502::indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x70 - 0x7f
+ &cpu_6502::execute<&cpu_6502::op_bvs, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sei, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<false>, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x80 - 0x8f
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dey, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_txa, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0x90 - 0x9f
+ &cpu_6502::execute<&cpu_6502::op_bcc, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::indirect_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::zero_page_indexed_mode_y>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tya, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_y_mode>,
+ &cpu_6502::execute<&cpu_6502::op_txs, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xa0 - 0xaf
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tay, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tax, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xb0 - 0xbf
+ &cpu_6502::execute<&cpu_6502::op_bcs, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::zero_page_indexed_mode_y>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_clv, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xc0 - 0xcf
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_iny, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dex, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xd0 - 0xdf
+ &cpu_6502::execute<&cpu_6502::op_bne, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cld, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xe0 - 0xef
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+
+ // 0xf0 - 0xff
+ &cpu_6502::execute<&cpu_6502::op_beq, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sed, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<false>, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_illegal, &cpu_6502::implied_mode>,
+};
+
+////////////////
+// 65c02 handlers
+////////////////
+cpu_6502::opcode_handler cpu_6502::m_65c02_handlers[] = {
+ // 0x00 - 0x0f
+ &cpu_6502::execute<&cpu_6502::op_brk<true>, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsb, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_php, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsb, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x10 - 0x1f
+ &cpu_6502::execute<&cpu_6502::op_bpl, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_trb, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_clc, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_trb, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ora, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_asl, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x20 - 0x2f
+ &cpu_6502::execute<&cpu_6502::op_jsr, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_plp, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x30 - 0x3f
+ &cpu_6502::execute<&cpu_6502::op_bmi, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sec, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_and, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_rol, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x40 - 0x4f
+ &cpu_6502::execute<&cpu_6502::op_rti, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_pha, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_jmp, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x50 - 0x5f
+ &cpu_6502::execute<&cpu_6502::op_bvc, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cli, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_phy, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_eor, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lsr, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x60 - 0x6f
+ &cpu_6502::execute<&cpu_6502::op_rts, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stz, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_pla, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror_acc, &cpu_6502::accumulator_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_jmp, &cpu_6502::indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x70 - 0x7f
+ &cpu_6502::execute<&cpu_6502::op_bvs, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stz, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sei, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ply, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_jmp, &cpu_6502::absolute_indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_adc<true>, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ror, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x80 - 0x8f
+ &cpu_6502::execute<&cpu_6502::op_bra, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dey, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_bit_immediate, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_txa, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0x90 - 0x9f
+ &cpu_6502::execute<&cpu_6502::op_bcc, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::indirect_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sty, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stx, &cpu_6502::zero_page_indexed_mode_y>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tya, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_y_mode>,
+ &cpu_6502::execute<&cpu_6502::op_txs, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stz, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sta, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_stz, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xa0 - 0xaf
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tay, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tax, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xb0 - 0xbf
+ &cpu_6502::execute<&cpu_6502::op_bcs, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::zero_page_indexed_mode_y>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_clv, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_tsx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldy, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_lda, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_ldx, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xc0 - 0xcf
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_iny, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dex, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpy, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xd0 - 0xdf
+ &cpu_6502::execute<&cpu_6502::op_bne, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cld, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_phx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cmp, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_dec, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xe0 - 0xef
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::indexed_indirect_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::zero_page_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_cpx, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+
+ // 0xf0 - 0xff
+ &cpu_6502::execute<&cpu_6502::op_beq, &cpu_6502::relative_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::indirect_indexed_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::zero_page_indirect>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::immediate_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::zero_page_indexed_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sed, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::absolute_y_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_plx, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::absolute_mode>,
+ &cpu_6502::execute<&cpu_6502::op_sbc<true>, &cpu_6502::absolute_x_check_boundary_mode>,
+ &cpu_6502::execute<&cpu_6502::op_inc, &cpu_6502::absolute_x_mode>,
+ &cpu_6502::execute<&cpu_6502::op_nop, &cpu_6502::implied_mode>,
+};
+
+//
+// fetch and execute the opcode at the program counter, returning the
+// number of cycles it took
+//
+inline uint32_t cpu_6502::execute_opcode()
+{
+	m_extra_cycles = 0;
+
+	// get the opcode at the program counter and then dispatch straight
+	// to the handler for it
+	uint8_t opcode = memory_read(m_pc++, true);
+	SDL_assert(m_opcodes[opcode].m_addr_mode != addr_mode::NO_MODE);
+	m_handlers[opcode](this);
+
+	return m_opcodes[opcode].m_cycle_count + m_extra_cycles;
+}
+
+//
+// main loop for opcode processing
+//
+uint32_t cpu_6502::process_opcode()
+{
+	return execute_opcode();
+}
+
+//
+// run opcodes until at least cycle_budget cycles have executed.  Unlike
+// process_opcode(), the global cycle counters are advanced here as each
+// opcode executes since soft switch handlers read them in the middle of
+// the timeslice.  At least one opcode is always executed.  We return
+// early when something calls request_exit(), when a scheduled event is
+// due, or when the program counter lands on an address set in break_map
+// (one bit per address), so the caller can deal with it before continuing
+//
+uint32_t cpu_6502::run(uint32_t cycle_budget, const uint8_t *break_map)
+{
+	uint32_t cycles = 0;
+
+	// the machine can't change during a timeslice, so look up the
+	// thread's machine once instead of after every opcode
+	apple2_machine *machine = Machine;
+	scheduler_state *scheduler = Scheduler;
+
+	m_exit_requested = false;
+	while (true) {
+		uint32_t opcode_cycles = execute_opcode();
+		cycles += opcode_cycles;
+		machine->m_total_cycles += opcode_cycles;
+		machine->m_total_cycles_this_frame += opcode_cycles;
+
+		if (cycles >= cycle_budget || m_exit_requested || machine->m_total_cycles >= scheduler->m_next_event_cycle) {
+			break;
+		}
+		if (break_map != nullptr && (break_map[m_pc >> 3] & (1 << (m_pc & 7)))) {
+			break;
+		}
+	}
+
+	return cycles;
+}
@@ -31,6 +31,8 @@ SOFTWARE.
 #include <functional>
 #include <stdint.h>
 
+class snapshot_writer;
+class snapshot_reader;
 
 class cpu_6502 {
 public:
@@ -71,6 +73,8 @@ public:
 	};
 
 	typedef int16_t(cpu_6502::*addr_func)(void);
+	typedef void(cpu_6502::*op_func)(uint16_t);
+	typedef void(*opcode_handler)(cpu_6502 *cpu);
 
 	typedef struct {
 		uint32_t    m_mnemonic;
@@ -87,11 +91,22 @@ private:
 	static opcode_info m_6502_opcodes[256];
 	static opcode_info m_65c02_opcodes[256];
 
+	/*
+	*  Per opcode handlers.  Each handler is the operation specialized with its
+	*  addressing mode so there is no decoding to do at runtime
+	*/
+	static opcode_handler m_6502_handlers[256];
+	static opcode_handler m_65c02_handlers[256];
+
 public:
 	cpu_6502() { }
 	void init(cpu_6502::cpu_mode mode);
 	uint32_t process_opcode();
+	uint32_t run(uint32_t cycle_budget, const uint8_t *break_map = nullptr);
+	void request_exit() { m_exit_requested = true; }
 	void set_pc(uint16_t pc) { m_pc = pc; }
+	void set_x(uint8_t x) { m_xindex = x; }
+	void set_y(uint8_t y) { m_yindex = y; }
 
 	// needed for debugger
 	uint16_t get_pc() { return m_pc; }
@@ -103,6 +118,10 @@ public:
 
 	cpu_6502::opcode_info *get_opcode(uint8_t opcode);
 
+	// registers for save states
+	void save_state(snapshot_writer &writer);
+	void load_state(snapshot_reader &reader);
+
 private:
 	uint16_t         m_pc;
 	uint8_t          m_sp;
@@ -111,8 +130,10 @@ private:
 	uint8_t          m_yindex;
 	uint8_t          m_status_register;
 	uint8_t          m_extra_cycles;
+	bool             m_exit_requested;
 
 	opcode_info*     m_opcodes;   // these are the currently valid opcodes
+	opcode_handler*  m_handlers;  // and the handlers that execute them
 
 	void set_flag(register_bit bit, uint8_t val) { m_status_register = (m_status_register & ~(1 << static_cast<uint8_t>(bit))) | (!!val << static_cast<uint8_t>(bit)); }
 	uint8_t get_flag(register_bit bit) { return (m_status_register >> static_cast<uint8_t>(bit)) & 0x1; }
@@ -141,6 +162,84 @@ private:
 	int16_t indirect_indexed_check_boundary_mode();
 
 	void branch_relative();
+	uint32_t execute_opcode();
+
+	template<op_func OP, addr_func ADDR> static void execute(cpu_6502 *cpu);
+
+	// operations.  The source address comes from the addressing mode
+	// and is ignored for the implied and accumulator operations
+	template<bool is_65c02> void op_adc(uint16_t src);
+	void op_and(uint16_t src);
+	void op_asl(uint16_t src);
+	void op_asl_acc(uint16_t src);
+	void op_bcc(uint16_t src);
+	void op_bcs(uint16_t src);
+	void op_beq(uint16_t src);
+	void op_bit(uint16_t src);
+	void op_bit_immediate(uint16_t src);
+	void op_bmi(uint16_t src);
+	void op_bne(uint16_t src);
+	void op_bpl(uint16_t src);
+	void op_bra(uint16_t src);
+	template<bool is_65c02> void op_brk(uint16_t src);
+	void op_bvc(uint16_t src);
+	void op_bvs(uint16_t src);
+	void op_clc(uint16_t src);
+	void op_cld(uint16_t src);
+	void op_cli(uint16_t src);
+	void op_clv(uint16_t src);
+	void op_cmp(uint16_t src);
+	void op_cpx(uint16_t src);
+	void op_cpy(uint16_t src);
+	void op_dec(uint16_t src);
+	void op_dec_acc(uint16_t src);
+	void op_dex(uint16_t src);
+	void op_dey(uint16_t src);
+	void op_eor(uint16_t src);
+	void op_inc(uint16_t src);
+	void op_inc_acc(uint16_t src);
+	void op_inx(uint16_t src);
+	void op_iny(uint16_t src);
+	void op_jmp(uint16_t src);
+	void op_jsr(uint16_t src);
+	void op_lda(uint16_t src);
+	void op_ldx(uint16_t src);
+	void op_ldy(uint16_t src);
+	void op_lsr(uint16_t src);
+	void op_lsr_acc(uint16_t src);
+	void op_nop(uint16_t src);
+	void op_ora(uint16_t src);
+	void op_pha(uint16_t src);
+	void op_phx(uint16_t src);
+	void op_phy(uint16_t src);
+	void op_pla(uint16_t src);
+	void op_plx(uint16_t src);
+	void op_ply(uint16_t src);
+	void op_php(uint16_t src);
+	void op_plp(uint16_t src);
+	void op_rol(uint16_t src);
+	void op_rol_acc(uint16_t src);
+	void op_ror(uint16_t src);
+	void op_ror_acc(uint16_t src);
+	void op_rti(uint16_t src);
+	void op_rts(uint16_t src);
+	template<bool is_65c02> void op_sbc(uint16_t src);
+	void op_sec(uint16_t src);
+	void op_sed(uint16_t src);
+	void op_sei(uint16_t src);
+	void op_sta(uint16_t src);
+	void op_stx(uint16_t src);
+	void op_sty(uint16_t src);
+	void op_stz(uint16_t src);
+	void op_tax(uint16_t src);
+	void op_trb(uint16_t src);
+	void op_tsb(uint16_t src);
+	void op_txa(uint16_t src);
+	void op_tay(uint16_t src);
+	void op_tya(uint16_t src);
+	void op_txs(uint16_t src);
+	void op_tsx(uint16_t src);
+	void op_illegal(uint16_t src);
 };
 
 
@@ -0,0 +1,336 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+//
+// batch runner.  Boots every disk image listed in a manifest with no
+// window, audio or frame cap, running one machine per job on a pool of
+// worker threads, and writes the final state of each job to a results
+// file.  Meant for regression testing a library of disk images.
+//
+// The manifest is made of "setting = value" lines.  Each image line
+// starts a new job, and the settings that follow it apply to that job
+// only.  Settings before the first image are the defaults for every job.
+// Lines starting with # are comments.
+//
+//   machine = 2ee
+//   frames = 600
+//
+//   image = disks/dos33.dsk
+//   keys = CATALOG\n
+//   exit_text = DISK VOLUME
+//
+// Settings are image, image2, machine (2, 2+, 2e or 2ee), cycles, frames,
+// exit_pc (hex), exit_text and keys (\n types a return).  Disks are never
+// written back, so the images in the library aren't changed by a run.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "apple2emu_defs.h"
+#include "apple2emu.h"
+#include "machine.h"
+
+struct batch_job {
+	// from the manifest
+	std::string          m_image;
+	std::string          m_image2;
+	emulator_type        m_type;
+	machine_run_options  m_options;
+	std::string          m_exit_text;
+	std::string          m_keys;
+
+	// results
+	bool                 m_loaded;
+	machine_run_result   m_result;
+	uint16_t             m_pc;
+	uint32_t             m_hash;
+	std::string          m_screen;
+};
+
+static std::vector<batch_job> Batch_jobs;
+
+// workers take the next job off the list until it runs out, so a long
+// running image only holds up the worker that is running it
+static std::atomic<size_t> Batch_next_job;
+
+static std::string batch_trim(const std::string &s)
+{
+	size_t start = s.find_first_not_of(" \t\r");
+	if (start == std::string::npos) {
+		return std::string();
+	}
+	size_t end = s.find_last_not_of(" \t\r");
+	return s.substr(start, end - start + 1);
+}
+
+// turns \n into a newline (which gets typed as return) and \\ into a backslash
+static std::string batch_unescape(const std::string &s)
+{
+	std::string out;
+	for (size_t i = 0; i < s.size(); i++) {
+		if (s[i] == '\\' && i + 1 < s.size()) {
+			i++;
+			out += (s[i] == 'n') ? '\n' : s[i];
+		} else {
+			out += s[i];
+		}
+	}
+	return out;
+}
+
+static bool batch_load_manifest(const char *filename)
+{
+	std::ifstream infile(filename);
+	if (infile.is_open() == false) {
+		printf("Unable to open manifest %s\n", filename);
+		return false;
+	}
+
+	batch_job defaults = {};
+	defaults.m_type = emulator_type::APPLE2E_ENHANCED;
+	defaults.m_options.m_exit_pc = -1;
+	batch_job *job = &defaults;
+
+	std::string line;
+	int line_num = 0;
+	while (std::getline(infile, line)) {
+		line_num++;
+		line = batch_trim(line);
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		size_t pos = line.find('=');
+		if (pos == std::string::npos) {
+			printf("%s(%d): expected setting = value\n", filename, line_num);
+			return false;
+		}
+		std::string setting = batch_trim(line.substr(0, pos));
+		std::string value = batch_trim(line.substr(pos + 1));
+
+		if (setting == "image") {
+			Batch_jobs.push_back(defaults);
+			job = &Batch_jobs.back();
+			job->m_image = value;
+		}
+		else if (setting == "image2") {
+			job->m_image2 = value;
+		}
+		else if (setting == "machine") {
+			if (machine_type_from_name(value.c_str(), job->m_type) == false) {
+				printf("%s(%d): unknown machine type %s (use 2, 2+, 2e or 2ee)\n", filename, line_num, value.c_str());
+				return false;
+			}
+		}
+		else if (setting == "cycles") {
+			job->m_options.m_max_cycles = strtoull(value.c_str(), nullptr, 10);
+		}
+		else if (setting == "frames") {
+			job->m_options.m_max_frames = strtoull(value.c_str(), nullptr, 10);
+		}
+		else if (setting == "exit_pc") {
+			job->m_options.m_exit_pc = (uint16_t)strtol(value.c_str(), nullptr, 16);
+		}
+		else if (setting == "exit_text") {
+			job->m_exit_text = value;
+		}
+		else if (setting == "keys") {
+			job->m_keys = batch_unescape(value);
+		}
+		else {
+			printf("%s(%d): unknown setting %s\n", filename, line_num, setting.c_str());
+			return false;
+		}
+	}
+
+	for (auto &j : Batch_jobs) {
+		if (j.m_options.m_max_cycles == 0 && j.m_options.m_max_frames == 0 && j.m_options.m_exit_pc == -1 && j.m_exit_text.empty()) {
+			printf("%s: %s needs at least one of cycles, frames, exit_pc or exit_text\n", filename, j.m_image.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// FNV-1a over the pixels of the rendered screen
+static uint32_t batch_hash_framebuffer()
+{
+	const uint32_t *pixels = video_get_framebuffer();
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < Video_native_width * Video_native_height; i++) {
+		hash = (hash ^ pixels[i]) * 16777619u;
+	}
+	return hash;
+}
+
+// boots the image(s) for the job on a fresh machine owned by this thread
+static void batch_run_job(batch_job &job)
+{
+	apple2_machine *machine = machine_create(job.m_type);
+	machine_set_current(machine);
+	machine_reset();
+
+	job.m_loaded = disk_insert(job.m_image.c_str(), 1, false);
+	if (job.m_loaded == true && job.m_image2.empty() == false) {
+		job.m_loaded = disk_insert(job.m_image2.c_str(), 2, false);
+	}
+
+	if (job.m_loaded == true) {
+		if (job.m_keys.empty() == false) {
+			keyboard_paste_text(job.m_keys.c_str());
+		}
+		machine_run_options options = job.m_options;
+		options.m_exit_text = job.m_exit_text.empty() ? nullptr : job.m_exit_text.c_str();
+		job.m_result = machine_run(options);
+		job.m_pc = Machine->m_cpu.get_pc();
+
+		video_invalidate();
+		video_render();
+		job.m_hash = batch_hash_framebuffer();
+		job.m_screen = video_get_screen_text();
+	}
+
+	machine_destroy(machine);
+}
+
+static void batch_worker()
+{
+	while (true) {
+		size_t index = Batch_next_job++;
+		if (index >= Batch_jobs.size()) {
+			break;
+		}
+		batch_run_job(Batch_jobs[index]);
+	}
+}
+
+// a job passes when its image loaded and, if it had an exit condition,
+// the condition was reached before a budget ran out
+static bool batch_job_passed(const batch_job &job)
+{
+	if (job.m_loaded == false) {
+		return false;
+	}
+	bool has_exit_condition = (job.m_options.m_exit_pc != -1) || (job.m_exit_text.empty() == false);
+	bool exited = (strcmp(job.m_result.m_exit_reason, "exit_pc") == 0) || (strcmp(job.m_result.m_exit_reason, "exit_text") == 0);
+	return has_exit_condition == false || exited == true;
+}
+
+// results are written in manifest order, in the same format as the
+// headless mode of the emulator
+static void batch_write_results(FILE *fp)
+{
+	for (auto &job : Batch_jobs) {
+		fprintf(fp, "%-10s%s\n", "image", job.m_image.c_str());
+		if (job.m_loaded == false) {
+			fprintf(fp, "%-10s%s\n\n", "exit", "load_failed");
+			continue;
+		}
+		fprintf(fp, "%-10s%s\n", "exit", job.m_result.m_exit_reason);
+		fprintf(fp, "%-10s%s\n", "result", batch_job_passed(job) ? "pass" : "fail");
+		fprintf(fp, "%-10s$%04x\n", "pc", job.m_pc);
+		fprintf(fp, "%-10s%llu\n", "cycles", static_cast<unsigned long long>(job.m_result.m_cycles));
+		fprintf(fp, "%-10s%llu\n", "frames", static_cast<unsigned long long>(job.m_result.m_frames));
+		fprintf(fp, "%-10s%08x\n", "hash", job.m_hash);
+		fprintf(fp, "%s\n", job.m_screen.c_str());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char *manifest_filename = nullptr;
+	const char *results_filename = nullptr;
+	uint32_t num_threads = std::thread::hardware_concurrency();
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i + 1 < argc) {
+			results_filename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+			num_threads = (uint32_t)strtol(argv[++i], nullptr, 10);
+		}
+		else if (manifest_filename == nullptr) {
+			manifest_filename = argv[i];
+		}
+	}
+	if (manifest_filename == nullptr) {
+		printf("usage: apple2batch manifest [-o results] [-j threads]\n");
+		return -1;
+	}
+	if (batch_load_manifest(manifest_filename) == false) {
+		return -1;
+	}
+	if (num_threads == 0) {
+		num_threads = 1;
+	}
+	num_threads = std::min(num_threads, static_cast<uint32_t>(Batch_jobs.size()));
+
+	uint64_t start_time = SDL_GetPerformanceCounter();
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < num_threads; i++) {
+		workers.emplace_back(batch_worker);
+	}
+	for (auto &w : workers) {
+		w.join();
+	}
+	double host_seconds = double(SDL_GetPerformanceCounter() - start_time) / SDL_GetPerformanceFrequency();
+
+	FILE *fp = stdout;
+	if (results_filename != nullptr) {
+		fp = fopen(results_filename, "wt");
+		if (fp == nullptr) {
+			printf("Unable to open %s for writing\n", results_filename);
+			return -1;
+		}
+	}
+	batch_write_results(fp);
+	if (fp != stdout) {
+		fclose(fp);
+	}
+
+	// summary goes to the console even when the results go to a file
+	int num_failed = 0;
+	uint64_t total_cycles = 0;
+	for (auto &job : Batch_jobs) {
+		num_failed += batch_job_passed(job) ? 0 : 1;
+		total_cycles += job.m_result.m_cycles;
+	}
+	double emulated_seconds = total_cycles / FREQ_6502;
+	printf("%zu jobs, %d failed, %u threads, %.3f host seconds, %.1fx\n", Batch_jobs.size(), num_failed, num_threads,
+		host_seconds, host_seconds > 0.0 ? emulated_seconds / host_seconds : 0.0);
+
+	return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+//
+// microbenchmarks for the emulator core.  Only built when cmake is run
+// with -DAPPLE2EMU_BENCHMARKS=ON.
+//
+//   apple2bench io [-n count]
+//   apple2bench cpu [-n slices]
+//
+// io times memory_read/memory_write through the soft switch and slot
+// handlers, in ns per access: a card in slot 6 (which replaces the disk
+// controller) at $C0EC/$C0ED, the $C011 status switch and plain ram at
+// $0800 for comparison.  Each is run three times and the fastest and
+// slowest are printed.
+//
+// cpu runs a checksum loop over $1000-$4fff with a $C000 poll every
+// page through cpu_6502::run(), in slices of ten frames, and prints the
+// emulated MHz and a checksum of the results.  The checksum has to stay
+// the same across changes to the cpu and memory code.
+//
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "apple2emu_defs.h"
+#include "apple2emu.h"
+#include "machine.h"
+
+static const int Bench_num_runs = 3;
+
+// stand in for a card that latches what is written to it
+static uint8_t bench_card_read(void *context, uint16_t addr)
+{
+	uint8_t *latch = static_cast<uint8_t *>(context);
+	return ++*latch + (addr & 1);
+}
+
+static void bench_card_write(void *context, uint16_t addr, uint8_t val)
+{
+	uint8_t *latch = static_cast<uint8_t *>(context);
+	*latch = val + (addr & 1);
+}
+
+// runs func count times, Bench_num_runs over, and prints the fastest
+// and slowest time per call
+template<typename F> static void bench_time(const char *name, uint32_t count, F func)
+{
+	double min_ns = 0.0, max_ns = 0.0;
+	for (int run = 0; run < Bench_num_runs; run++) {
+		uint64_t start_time = SDL_GetPerformanceCounter();
+		for (uint32_t i = 0; i < count; i++) {
+			func(i);
+		}
+		double ns = double(SDL_GetPerformanceCounter() - start_time) * 1e9 / SDL_GetPerformanceFrequency() / count;
+		min_ns = run == 0 ? ns : std::min(min_ns, ns);
+		max_ns = run == 0 ? ns : std::max(max_ns, ns);
+	}
+	printf("%-22s %6.2f - %6.2f ns\n", name, min_ns, max_ns);
+}
+
+static void bench_io(uint32_t count)
+{
+	apple2_machine *machine = machine_create(emulator_type::APPLE2E_ENHANCED);
+	machine_set_current(machine);
+	machine_reset();
+
+	uint8_t latch = 0;
+	slot_device card = {};
+	card.m_io_read = bench_card_read;
+	card.m_io_write = bench_card_write;
+	card.m_context = &latch;
+	memory_register_slot_handler(6, card);
+
+	// the reads are summed and printed so that they can't be optimized away
+	uint32_t sum = 0;
+	bench_time("slot read   $C0EC", count, [&](uint32_t) { sum += memory_read(0xc0ec); });
+	bench_time("slot write  $C0ED", count, [&](uint32_t i) { memory_write(0xc0ed, uint8_t(i)); });
+	bench_time("status read $C011", count, [&](uint32_t) { sum += memory_read(0xc011); });
+	bench_time("ram read    $0800", count, [&](uint32_t) { sum += memory_read(0x0800); });
+	printf("(sum %08x)\n", sum);
+
+	machine_destroy(machine);
+}
+
+static void bench_cpu(uint32_t count)
+{
+	apple2_machine *machine = machine_create(emulator_type::APPLE2E_ENHANCED);
+	machine_set_current(machine);
+	machine_reset();
+
+	// adds up the 256 bytes at ($06) into $4000,y for each of $40 pages
+	// from $1000 up, reading the keyboard between pages
+	static const uint8_t program[] = {
+		0xa9, 0x10,        //       lda #$10
+		0x85, 0x07,        //       sta $07
+		0xa9, 0x00,        //       lda #$00
+		0x85, 0x06,        //       sta $06
+		0xa8,              //       tay
+		0xa2, 0x40,        //       ldx #$40
+		0x18,              //       clc
+		0x71, 0x06,        // loop  adc ($06),y
+		0x99, 0x00, 0x40,  //       sta $4000,y
+		0xc8,              //       iny
+		0xd0, 0xf8,        //       bne loop
+		0xad, 0x00, 0xc0,  //       lda $c000
+		0xe6, 0x07,        //       inc $07
+		0xca,              //       dex
+		0xd0, 0xf0,        //       bne loop
+		0x4c, 0x00, 0x08,  //       jmp $0800
+	};
+	memory_load_buffer(const_cast<uint8_t *>(program), sizeof(program), 0x800);
+	Machine->m_cpu.set_pc(0x800);
+
+	uint64_t start_cycles = Machine->m_total_cycles;
+	uint64_t start_time = SDL_GetPerformanceCounter();
+	for (uint32_t i = 0; i < count; i++) {
+		Machine->m_total_cycles_this_frame = 0;
+		Machine->m_cpu.run(Cycles_per_frame * 10);
+	}
+	double host_seconds = double(SDL_GetPerformanceCounter() - start_time) / SDL_GetPerformanceFrequency();
+
+	uint32_t checksum = 0;
+	for (uint16_t addr = 0x4000; addr < 0x4100; addr++) {
+		checksum = checksum * 31 + memory_read(addr);
+	}
+	printf("%.1f emulated MHz  (checksum %08x a %02x)\n", (Machine->m_total_cycles - start_cycles) / host_seconds / 1e6,
+		checksum, Machine->m_cpu.get_acc());
+
+	machine_destroy(machine);
+}
+
+int main(int argc, char* argv[])
+{
+	const char *name = nullptr;
+	uint32_t count = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--count") == 0) && i + 1 < argc) {
+			count = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (name == nullptr) {
+			name = argv[i];
+		}
+	}
+	if (name == nullptr) {
+		printf("usage: apple2bench io [-n count]\n");
+		printf("       apple2bench cpu [-n slices]\n");
+		return -1;
+	}
+
+	if (strcmp(name, "io") == 0) {
+		bench_io(count != 0 ? count : 50000000);
+	}
+	else if (strcmp(name, "cpu") == 0) {
+		bench_cpu(count != 0 ? count : 3000);
+	}
+	else {
+		printf("Unknown benchmark %s\n", name);
+		return -1;
+	}
+	return 0;
+}
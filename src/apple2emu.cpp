@@ -30,6 +30,7 @@ SOFTWARE.
 #include <algorithm>
 #include <string>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include "apple2emu_defs.h"
@@ -42,6 +43,10 @@ SOFTWARE.
 #include "keyboard.h"
 #include "joystick.h"
 #include "speaker.h"
+#include "scheduler.h"
+#include "machine.h"
+#include "rewind.h"
+#include "snapshot.h"
 #include "debugger.h"
 #include "path_utils.h"
 #include "interface.h"
@@ -66,12 +71,16 @@ const char *Emulator_names[static_cast<uint8_t>(emulator_type::NUM_EMULATOR_TYPE
 };
 
 // globals used to control emulator
-uint32_t Speed_multiplier = 1;
+float Emulator_speed = 1.0f;
+bool Emulator_warp = false;
+bool Disk_turbo = false;
+bool Emulator_idle_skip = true;
+uint32_t Disk_turbo_linger_frames = 30;
 bool Auto_start = false;
 emulator_state Emulator_state = emulator_state::SPLASH_SCREEN;
-emulator_type Emulator_type = emulator_type::APPLE2;
 
 static const char *Disk_image_filename = nullptr;
+static const char *Disk2_image_filename = nullptr;
 static const char *Binary_image_filename = nullptr;
 static int32_t Program_start_addr = -1;
 static int32_t Program_load_addr = -1;
@@ -80,12 +89,38 @@ static const char *Log_filename = nullptr;
 static FILE *Log_file = nullptr;
 
 static float Framecap_ms;
-uint32_t Frames_per_second = 60;
 
-uint32_t Total_cycles, Total_cycles_this_frame;
-
-cpu_6502 cpu;
-Z80_STATE z80_cpu;
+// pacing.  Emulated cycles are owed at Emulator_speed times the real
+// clock and paid off each pass through the main loop.  The credit is
+// capped so that the machine doesn't race to catch up after a stall
+// (like dragging the window)
+static double Speed_cycle_credit = 0.0;
+static const double Max_cycle_credit_frames = 4.0;
+
+// disk turbo.  The cycle count the last time a drive motor was seen on,
+// and the wall clock time that running those bursts flat out has saved
+static uint64_t Disk_turbo_last_active_cycle = 0;
+static bool Disk_turbo_seen_active = false;
+static double Disk_turbo_seconds_saved = 0.0;
+
+// set when some of the last pass was skipped over as idle, in which case
+// the frame cap waits on events instead of sleeping
+static bool Idle_this_pass = false;
+
+// running without a window, audio or frame cap (--headless).  The run
+// stops at the first of the budgets or exit conditions that are given
+static bool Headless = false;
+static uint64_t Headless_max_cycles = 0;
+static uint64_t Headless_max_frames = 0;
+static int32_t Headless_exit_pc = -1;
+static const char *Headless_exit_text = nullptr;
+static const char *Headless_keys = nullptr;
+static const char *Headless_screenshot_filename = nullptr;
+static bool Headless_print_screen = false;
+static const char *Headless_save_state_filename = nullptr;
+
+// save state to start from (--load-state)
+static const char *Load_state_filename = nullptr;
 
 static char *get_cmdline_option(char **start, char **end, const std::string &short_option, const std::string &long_option = "")
 {
@@ -141,26 +176,7 @@ bool dissemble_6502(const char *filename)
 
 void reset_machine()
 {
-	cpu_6502::cpu_mode mode;
-
-	// ui_init() will load up settings.  Need this before
-	// we set the opcodes we need
-
-	if (Emulator_type == emulator_type::APPLE2E_ENHANCED) {
-		mode = cpu_6502::cpu_mode::CPU_65C02;
-	} else {
-		mode = cpu_6502::cpu_mode::CPU_6502;
-	}
-	memory_init();
-	cpu.init(mode);
-	z80softcard_init();
-	speaker_init();
-	keyboard_init();
-	joystick_init();
-	disk_init();
-	video_init();
-
-	z80softcard_reset(&z80_cpu);
+	machine_reset();
 
 	if (Binary_image_filename != nullptr && Program_start_addr != -1) {
 		FILE *fp = fopen(Binary_image_filename, "rb");
@@ -183,7 +199,7 @@ void reset_machine()
 		fread(buffer, 1, buffer_size, fp);
 		fclose(fp);
 		memory_load_buffer(buffer, (uint16_t)buffer_size, (uint16_t)Program_load_addr);
-		cpu.set_pc((uint16_t)Program_start_addr);
+		Machine->m_cpu.set_pc((uint16_t)Program_start_addr);
 		Emulator_state = emulator_state::EMULATOR_TEST;
 		debugger_enter();
 	}
@@ -195,21 +211,157 @@ static void apple2emu_shutdown()
 		fclose(Log_file);
 	}
 
-	ui_shutdown();
+	if (Headless == false) {
+		ui_shutdown();
+		if (Disk_turbo_seconds_saved > 0.0) {
+			printf("Disk turbo saved %.1f seconds\n", Disk_turbo_seconds_saved);
+		}
+	}
 	video_shutdown();
-	disk_shutdown();
 	keyboard_shutdown();
 	joystick_shutdown();
 	debugger_shutdown();
-	memory_shutdown();
+	machine_destroy(Machine);
 
 	SDL_Quit();
 }
 
+// run the machine as fast as possible with no window until one of the
+// budgets or exit conditions is reached, then write out the results.
+// Returns the process exit code -- 1 if there was an exit condition and
+// a budget ran out before it happened
+static int apple2emu_run_headless()
+{
+	if (Headless_keys != nullptr) {
+		keyboard_paste_text(Headless_keys);
+	}
+
+	machine_run_options options = {};
+	options.m_max_cycles = Headless_max_cycles;
+	options.m_max_frames = Headless_max_frames;
+	options.m_exit_pc = Headless_exit_pc;
+	options.m_exit_text = Headless_exit_text;
+
+	Emulator_state = emulator_state::EMULATOR_STARTED;
+	uint64_t start_time = SDL_GetPerformanceCounter();
+	machine_run_result result = machine_run(options);
+	double host_seconds = double(SDL_GetPerformanceCounter() - start_time) / SDL_GetPerformanceFrequency();
+	double emulated_seconds = result.m_cycles / FREQ_6502;
+
+	if (Headless_screenshot_filename != nullptr) {
+		video_invalidate();
+		video_render();
+		video_save_screenshot(Headless_screenshot_filename);
+	}
+	if (Headless_print_screen) {
+		printf("%s", video_get_screen_text().c_str());
+	}
+	if (Headless_save_state_filename != nullptr) {
+		machine_snapshot snapshot;
+		snapshot_capture(snapshot);
+		snapshot_save(snapshot, Headless_save_state_filename);
+	}
+
+	printf("%-10s%s\n", "exit", result.m_exit_reason);
+	printf("%-10s$%04x\n", "pc", Machine->m_cpu.get_pc());
+	printf("%-10s%llu\n", "cycles", static_cast<unsigned long long>(result.m_cycles));
+	printf("%-10s%llu\n", "frames", static_cast<unsigned long long>(result.m_frames));
+	printf("%-10s%.3f\n", "emulated", emulated_seconds);
+	printf("%-10s%.3f\n", "host", host_seconds);
+	printf("%-10s%.1fx\n", "speed", host_seconds > 0.0 ? emulated_seconds / host_seconds : 0.0);
+
+	bool has_exit_condition = (Headless_exit_pc != -1) || (Headless_exit_text != nullptr);
+	bool exited = (strcmp(result.m_exit_reason, "exit_pc") == 0) || (strcmp(result.m_exit_reason, "exit_text") == 0);
+	return (has_exit_condition && !exited) ? 1 : 0;
+}
+
+// run the machine up to the given cycle count, ending frames along the
+// way.  Returns false if the debugger stopped the machine first
+static bool apple2emu_run_until(uint64_t target_cycles)
+{
+	while (Machine->m_total_cycles < target_cycles) {
+		// process debugger (before opcode processing so that we can break on
+		// specific addresses properly
+		if (debugger_process() == false) {
+			return false;
+		}
+
+		// note that we might emulate z80 or 6502 here.  Unless the
+		// debugger needs to see every opcode, let the 6502 run up to the
+		// end of the frame or the target in one go.  It advances the
+		// cycle counters itself.
+		uint32_t cycles = z80softcard_emulate(&Machine->m_z80_cpu, 0);
+		if (cycles == 0 && debugger_stepping() == false) {
+			uint64_t budget = std::min<uint64_t>(Cycles_per_frame - Machine->m_total_cycles_this_frame + 1, target_cycles - Machine->m_total_cycles);
+			Machine->m_cpu.run(static_cast<uint32_t>(budget), debugger_get_break_map());
+
+			// skip over the machine waiting on the keyboard, but never past
+			// the end of the frame, the target or the next scheduled event
+			uint64_t total = Machine->m_total_cycles;
+			if (Machine->m_total_cycles_this_frame <= Cycles_per_frame && target_cycles > total && Scheduler->m_next_event_cycle > total) {
+				uint64_t max_cycles = std::min<uint64_t>({ Cycles_per_frame - Machine->m_total_cycles_this_frame + 1, target_cycles - total, Scheduler->m_next_event_cycle - total });
+				uint32_t skipped = keyboard_skip_idle_polls(max_cycles);
+				if (skipped > 0) {
+					Machine->m_total_cycles += skipped;
+					Machine->m_total_cycles_this_frame += skipped;
+					Idle_this_pass = true;
+				}
+			}
+		} else {
+			if (cycles == 0) {
+				cycles = Machine->m_cpu.process_opcode();
+			}
+			Machine->m_total_cycles_this_frame += cycles;
+			Machine->m_total_cycles += cycles;
+		}
+
+		// run any peripheral events that are due and update
+		// the speaker if needed
+		scheduler_process(Machine->m_total_cycles);
+		speaker_update();
+
+		if (Machine->m_total_cycles_this_frame > Cycles_per_frame) {
+			// this is essentially number of cycles for one redraw cycle
+			// for TV/monitor.  Around 17030 cycles I believe
+			Machine->m_total_cycles_this_frame -= Cycles_per_frame;
+			memory_end_frame();
+			rewind_end_frame();
+		}
+	}
+	return true;
+}
+
+// true while a drive motor is on and for Disk_turbo_linger_frames
+// after it goes off.  DOS turns the motor off between most calls, so
+// without some slack a load would drop in and out of turbo
+static bool apple2emu_disk_turbo_active()
+{
+	if (Disk_turbo == false) {
+		return false;
+	}
+	if (disk_is_on(1) || disk_is_on(2)) {
+		Disk_turbo_last_active_cycle = Machine->m_total_cycles;
+		Disk_turbo_seen_active = true;
+		return true;
+	}
+	return Disk_turbo_seen_active &&
+		Machine->m_total_cycles - Disk_turbo_last_active_cycle < uint64_t(Disk_turbo_linger_frames) * Cycles_per_frame;
+}
+
+double apple2emu_get_disk_turbo_seconds_saved()
+{
+	return Disk_turbo_seconds_saved;
+}
+
 int main(int argc, char* argv[])
 {
+	// the machine needs to exist before the settings are loaded since
+	// they set the machine type, tint and mounted disks
+	machine_set_current(machine_create(emulator_type::APPLE2));
+
 	// grab some needed command line options
 	Disk_image_filename = get_cmdline_option(argv, argv + argc, "-d", "--disk");
+	Disk2_image_filename = get_cmdline_option(argv, argv + argc, "--disk2");
 	Binary_image_filename = get_cmdline_option(argv, argv + argc, "-b", "--binary");
 
 	const char *addr_string = get_cmdline_option(argv, argv + argc, "-p", "--pc");
@@ -223,32 +375,91 @@ int main(int argc, char* argv[])
 	}
 
 	bool test_z80 = cmdline_option_exists(argv, argv + argc, "-z", "--z80");
+	Memory_use_huge_pages = cmdline_option_exists(argv, argv + argc, "-H", "--huge-pages");
 	Log_filename = get_cmdline_option(argv, argv + argc, "-l", "--log");
 	if (Log_filename != nullptr) {
 		Log_file = fopen(Log_filename, "wt");
 	}
 
+	// options for headless runs.  Settings are not loaded when headless
+	// so the machine type comes from the command line too
+	Headless = cmdline_option_exists(argv, argv + argc, "--headless");
+	const char *option = get_cmdline_option(argv, argv + argc, "-m", "--machine");
+	if (option != nullptr && machine_type_from_name(option, Machine->m_type) == false) {
+		printf("Unknown machine type %s (use 2, 2+, 2e or 2ee)\n", option);
+		return -1;
+	}
+	if ((option = get_cmdline_option(argv, argv + argc, "--cycles")) != nullptr) {
+		Headless_max_cycles = strtoull(option, nullptr, 10);
+	}
+	if ((option = get_cmdline_option(argv, argv + argc, "--frames")) != nullptr) {
+		Headless_max_frames = strtoull(option, nullptr, 10);
+	}
+	if ((option = get_cmdline_option(argv, argv + argc, "--exit-pc")) != nullptr) {
+		Headless_exit_pc = (uint16_t)strtol(option, nullptr, 16);
+	}
+	Headless_exit_text = get_cmdline_option(argv, argv + argc, "--exit-text");
+	Headless_keys = get_cmdline_option(argv, argv + argc, "--keys");
+	Headless_screenshot_filename = get_cmdline_option(argv, argv + argc, "--screenshot");
+	Headless_print_screen = cmdline_option_exists(argv, argv + argc, "--print-screen");
+	Headless_save_state_filename = get_cmdline_option(argv, argv + argc, "--save-state");
+	Load_state_filename = get_cmdline_option(argv, argv + argc, "--load-state");
+	if (Headless && Headless_max_cycles == 0 && Headless_max_frames == 0 && Headless_exit_pc == -1 && Headless_exit_text == nullptr) {
+		printf("Headless mode needs at least one of --cycles, --frames, --exit-pc or --exit-text\n");
+		return -1;
+	}
+
 	// set up atexit handler to clean everything up
 	atexit(apple2emu_shutdown);
 
-	// initialize SDL before everything else
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER | SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER) != 0) {
+	// initialize SDL before everything else.  Headless runs don't
+	// open a window, audio device or controllers
+	uint32_t sdl_flags = SDL_INIT_TIMER;
+	if (Headless == false) {
+		sdl_flags |= SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER;
+	}
+	if (SDL_Init(sdl_flags) != 0) {
 		printf("Error initializing SDL: %s\n", SDL_GetError());
 		return -1;
 	}
 	configure_logging();
 	debugger_init();
-	ui_init();
+	if (Headless == false) {
+		ui_init();
+	}
 	reset_machine();
 
+	// disks on the command line replace the ones from the settings
+	if (Disk_image_filename != nullptr && disk_insert(Disk_image_filename, 1) == false) {
+		printf("Unable to insert disk image %s\n", Disk_image_filename);
+		return -1;
+	}
+	if (Disk2_image_filename != nullptr && disk_insert(Disk2_image_filename, 2) == false) {
+		printf("Unable to insert disk image %s\n", Disk2_image_filename);
+		return -1;
+	}
+
+	// a save state replaces everything, including the disks and the
+	// machine type
+	if (Load_state_filename != nullptr) {
+		machine_snapshot snapshot;
+		if (snapshot_load(snapshot, Load_state_filename) == false || snapshot_restore(snapshot) == false) {
+			return -1;
+		}
+	}
+
+	if (Headless) {
+		return apple2emu_run_headless();
+	}
+
 	if (test_z80) {
 		SDL_Quit();
-		Emulator_type = emulator_type::APPLE2;
+		Machine->m_type = emulator_type::APPLE2;
 		memory_init_for_z80_test();
-		z80_cpu.status = 0;
-		z80_cpu.pc = Program_start_addr;
+		Machine->m_z80_cpu.status = 0;
+		Machine->m_z80_cpu.pc = Program_start_addr;
 		while (true) {
-			z80softcard_emulate(&z80_cpu, 0);
+			z80softcard_emulate(&Machine->m_z80_cpu, 0);
 		}
 		exit(0);
 	}
@@ -259,42 +470,65 @@ int main(int argc, char* argv[])
 	}
 
 	bool quit = false;
-	Total_cycles_this_frame = Total_cycles = 0;
+	uint64_t last_pace_time = SDL_GetPerformanceCounter();
 
 	while (!quit) {
-		uint32_t cycles_per_frame = Cycles_per_frame * Speed_multiplier;  // we can speed up machine by multiplier here
-		
-		// process the next opcode
+		uint64_t pace_time = SDL_GetPerformanceCounter();
+		double elapsed = double(pace_time - last_pace_time) / SDL_GetPerformanceFrequency();
+		last_pace_time = pace_time;
+
 		if (Emulator_state == emulator_state::EMULATOR_STARTED ||
 			Emulator_state == emulator_state::EMULATOR_TEST) {
+			speaker_set_speed(Emulator_speed);
+			bool turbo = Emulator_warp == false && apple2emu_disk_turbo_active();
+			keyboard_set_idle_skip(Emulator_idle_skip);
+			Idle_this_pass = false;
+			speaker_set_muted(Emulator_warp || turbo);
 			speaker_unpause();
-			while (true) {
-				// process debugger (before opcode processing so that we can break on
-				// specific addresses properly
-				bool next_statement = debugger_process();
-
-				if (next_statement) {
-					// note that we might emulate z80 or 6502 here
-					uint32_t cycles = z80softcard_emulate(&z80_cpu, 0);
-					if (cycles == 0) {
-						cycles = cpu.process_opcode();
+			if (Emulator_warp || turbo) {
+				// run whole frames until it is time to show one.  Only the
+				// last of them gets drawn.  Disk turbo also stops as soon as
+				// the drives have been quiet long enough
+				uint64_t present_time = pace_time + SDL_GetPerformanceFrequency() / Frames_per_second;
+				uint64_t start_cycles = Machine->m_total_cycles;
+				while (apple2emu_run_until(Machine->m_total_cycles + Cycles_per_frame - Machine->m_total_cycles_this_frame + 1)) {
+					if (SDL_GetPerformanceCounter() >= present_time) {
+						break;
 					}
-					Total_cycles_this_frame += cycles;
-					Total_cycles += cycles;
-
-					// update speaker if needed
-					speaker_update(cycles);
-
-					if (Total_cycles_this_frame > cycles_per_frame) {
-						// this is essentially number of cycles for one redraw cycle
-						// for TV/monitor.  Around 17030 cycles I believe
-						Total_cycles_this_frame -= cycles_per_frame;
+					if (turbo && apple2emu_disk_turbo_active() == false) {
 						break;
 					}
-				} else {
-					break;
+				}
+				Speed_cycle_credit = 0.0;
+
+				if (turbo) {
+					// time the same cycles would have taken at the set speed
+					// less the time they actually took
+					double emulated = double(Machine->m_total_cycles - start_cycles) / (FREQ_6502 * Emulator_speed);
+					double actual = double(SDL_GetPerformanceCounter() - pace_time) / SDL_GetPerformanceFrequency();
+					Disk_turbo_seconds_saved += emulated - actual;
+				}
+			} else {
+				// whole frames are run while cycles are owed so that the
+				// display always shows a finished frame.  Below 1x this skips
+				// passes, above it runs several frames per pass
+				double max_credit = Max_cycle_credit_frames * Cycles_per_frame * Emulator_speed;
+				Speed_cycle_credit = std::min(Speed_cycle_credit + elapsed * FREQ_6502 * Emulator_speed, max_credit);
+				while (Speed_cycle_credit > 0.0) {
+					uint64_t start_cycles = Machine->m_total_cycles;
+					if (apple2emu_run_until(start_cycles + Cycles_per_frame - Machine->m_total_cycles_this_frame + 1) == false) {
+						// stopped in the debugger
+						Speed_cycle_credit = 0.0;
+						break;
+					}
+					Speed_cycle_credit -= double(Machine->m_total_cycles - start_cycles);
 				}
 			}
+		} else if (Emulator_state == emulator_state::EMULATOR_REWINDING) {
+			// one frame back for every frame shown, so the machine runs
+			// backwards at normal speed
+			speaker_pause();
+			rewind_step_back(1);
 		} else {
 			debugger_process();
 		}
@@ -324,18 +558,23 @@ int main(int argc, char* argv[])
 		ui_do_frame();
 
 
-		// framerate cap in millisconds
+		// framerate cap in millisconds.  Warp and disk turbo don't wait
 		static uint64_t last_time = 0;
 		uint64_t start;
 		Framecap_ms = (1.0f / Frames_per_second) * 1000;
 
 		//  used for framerate limiting
 		start = SDL_GetPerformanceCounter();
-		if (last_time != 0) {
+		if (last_time != 0 && Emulator_warp == false && apple2emu_disk_turbo_active() == false) {
 			int32_t sleep_ms = (uint32_t)(Framecap_ms - (1000 * (start - last_time) / SDL_GetPerformanceFrequency()));
 			if (sleep_ms > 0) {
 				//SDL_LogVerbose(SDL_LOG_CATEGORY_ERROR, "%d\n", sleep_ms);
-				SDL_Delay(sleep_ms);
+				if (Idle_this_pass) {
+					// nothing else to do but wait on a key, so wake up for one
+					SDL_WaitEventTimeout(nullptr, sleep_ms);
+				} else {
+					SDL_Delay(sleep_ms);
+				}
 			}
 		}
 		last_time = SDL_GetPerformanceCounter();
@@ -34,6 +34,7 @@ enum class emulator_state : uint8_t {
 	EMULATOR_STARTED,
 	EMULATOR_PAUSED,
 	EMULATOR_TEST,
+	EMULATOR_REWINDING,      // stepping back through the rewind history
 };
 
 enum class emulator_type: uint8_t {
@@ -81,16 +82,14 @@ const uint32_t Cycles_per_frame = Vert_state_counter * Horz_state_counter;
 
 extern uint32_t Frames_per_second;
 
-// several externs for cycle counting
-extern uint32_t Total_cycles;
-extern uint32_t Total_cycles_this_frame;
-
 // globals for controlling the emulator.  Tied into interface
-extern uint32_t Speed_multiplier;
+extern float Emulator_speed;     // 1.0 is a real apple, 0.5 half as fast, and so on
+extern bool Emulator_warp;       // run as fast as the host allows
+extern bool Disk_turbo;          // warp while a disk drive motor is on
+extern bool Emulator_idle_skip;  // skip over the machine waiting on the keyboard
+extern uint32_t Disk_turbo_linger_frames;  // frames to keep warping after the motor stops
 extern bool Auto_start;
 extern emulator_state Emulator_state;
-extern emulator_type Emulator_type;
-
-extern cpu_6502 cpu;
 
 void reset_machine();
+double apple2emu_get_disk_turbo_seconds_saved();
@@ -49,6 +49,16 @@ SOFTWARE.
 
 #endif
 
+// storage for the per thread machine pointers.  The compiler keywords
+// are used instead of thread_local since thread_local makes every access
+// from another file check for a dynamic initializer first, and these
+// pointers are read on every memory access
+#if defined(_WIN32) || defined(_WIN64)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 // define for helping to clear out unreferenced
 // parameter warmings
 #define UNREFERENCED(X) (void)X
@@ -41,6 +41,7 @@
 #include "debugger_console.h"
 #include "debugger_memory.h"
 #include "debugger_disasm.h"
+#include "machine.h"
 
 debugger_state Debugger_state = debugger_state::IDLE;
 
@@ -51,6 +52,10 @@ static char Debugger_status_line[Debugger_status_line_length];
 
 static FILE *Debugger_trace_fp = nullptr;
 
+// one bit per address for the breakpoints so the cpu can check them
+// without calling into the debugger for every opcode
+static uint8_t Debugger_break_map[0x10000 / 8];
+
 // definitions for windows
 static debugger_console Debugger_console;
 static debugger_memory_editor Debugger_memory_editor;
@@ -67,12 +72,12 @@ auto step_command = [](char *) { Debugger_state = debugger_state::SINGLE_STEP; }
 auto next_command = [](char *) {
 	// look at current opcode. If jsr, then get next opcode
 	// after jsr, store, and go into step over mode
-	cpu_6502::opcode_info *opcode = cpu.get_opcode(memory_read(cpu.get_pc()));
+	cpu_6502::opcode_info *opcode = Machine->m_cpu.get_opcode(memory_read(Machine->m_cpu.get_pc()));
 	if (opcode->m_mnemonic == 'JSR ') {
 		breakpoint b;
 
 		b.m_type = breakpoint_type::TEMPORARY;
-		b.m_addr = cpu.get_pc() + opcode->m_size;
+		b.m_addr = Machine->m_cpu.get_pc() + opcode->m_size;
 		b.m_enabled = true;
 		Debugger_breakpoints.push_back(b);
 		Debugger_state = debugger_state::STEP_OVER;
@@ -83,7 +88,7 @@ auto next_command = [](char *) {
 };
 auto continue_command = [](char *) { Debugger_state = debugger_state::SHOW_ALL; };
 auto stop_command = [](char *) { Debugger_state = debugger_state::SINGLE_STEP; };
-auto exit_command = [](char *) { Debugger_state = debugger_state::IDLE; };
+auto exit_command = [](char *) { debugger_exit(); };
 
 auto quit_command = [](char *) {
 	exit(-1);
@@ -189,10 +194,10 @@ auto trace_command = [](char *) {
 // print out the status (PC, regs, etc)
 static void debugger_get_short_status()
 {
-	uint8_t status = cpu.get_status();
+	uint8_t status = Machine->m_cpu.get_status();
 	snprintf(Debugger_status_line, Debugger_status_line_length,
 		"%02X %02X %02X %04X %c%c%c%c%c%c%c%c",
-		cpu.get_acc(), cpu.get_x(), cpu.get_y(), cpu.get_sp() + 0x100,
+		Machine->m_cpu.get_acc(), Machine->m_cpu.get_x(), Machine->m_cpu.get_y(), Machine->m_cpu.get_sp() + 0x100,
 		(status >> 7) & 1 ? 'N' : '.',
 		(status >> 6) & 1 ? 'V' : '.',
 		(status >> 5) & 1 ? 'R' : '.',
@@ -211,8 +216,8 @@ static void debugger_trace_line()
 
 	// print out the info the trace file
 	debugger_get_short_status();
-	Debugger_disasm.get_disassembly(cpu.get_pc());
-	fprintf(Debugger_trace_fp, "%08X %s  %s\n", Total_cycles, Debugger_status_line, Debugger_disasm.get_disassembly_line());
+	Debugger_disasm.get_disassembly(Machine->m_cpu.get_pc());
+	fprintf(Debugger_trace_fp, "%08llX %s  %s\n", (unsigned long long)Machine->m_total_cycles, Debugger_status_line, Debugger_disasm.get_disassembly_line());
 }
 
 // display the disassembly in the disassembly window
@@ -224,12 +229,17 @@ void debugger_enter()
 		Emulator_state = emulator_state::EMULATOR_STARTED;
 	}
 	Debugger_state = debugger_state::WAITING_FOR_INPUT;
-	Debugger_disasm.set_break_addr(cpu.get_pc());
+	Debugger_disasm.set_break_addr(Machine->m_cpu.get_pc());
+
+	// keep track of opcode addresses for the disassembly while
+	// the debugger is up
+	memory_set_opcode_tracking(true);
 }
 
 void debugger_exit()
 {
 	Debugger_state = debugger_state::IDLE;
+	memory_set_opcode_tracking(false);
 }
 
 void debugger_shutdown()
@@ -273,7 +283,7 @@ bool debugger_process()
 {
 	bool continue_execution = true;
 	static breakpoint *active_breakpoint  = nullptr;
-	uint16_t pc = cpu.get_pc();
+	uint16_t pc = Machine->m_cpu.get_pc();
 
 	// check on breakpoints
 	if (Debugger_state == debugger_state::IDLE ||
@@ -349,10 +359,39 @@ bool debugger_active()
 	return Debugger_state != debugger_state::IDLE;
 }
 
+// returns true when the debugger needs to see every opcode (stepping
+// or tracing).  Otherwise the cpu can run freely and only needs to stop
+// on the addresses in the break map
+bool debugger_stepping()
+{
+	if (Debugger_trace_fp != nullptr) {
+		return true;
+	}
+	return Debugger_state != debugger_state::IDLE && Debugger_state != debugger_state::SHOW_ALL;
+}
+
+// build the break map for the currently enabled breakpoints.  Returns
+// nullptr when there is nothing to break on
+const uint8_t *debugger_get_break_map()
+{
+	bool have_breakpoints = false;
+	for (auto &bp : Debugger_breakpoints) {
+		if (bp.m_enabled == true && (bp.m_type == breakpoint_type::BREAKPOINT || bp.m_type == breakpoint_type::TEMPORARY)) {
+			if (have_breakpoints == false) {
+				memset(Debugger_break_map, 0, sizeof(Debugger_break_map));
+				have_breakpoints = true;
+			}
+			Debugger_break_map[bp.m_addr >> 3] |= 1 << (bp.m_addr & 7);
+		}
+	}
+
+	return have_breakpoints ? Debugger_break_map : nullptr;
+}
+
 void debugger_render()
 {
 	Debugger_memory_editor.draw("Memory", 0x10000, 0);
-	Debugger_disasm.draw("Disassembly", cpu.get_pc());
+	Debugger_disasm.draw("Disassembly", Machine->m_cpu.get_pc());
 	Debugger_console.draw("Console", nullptr);
 
 	Reset_windows = false;
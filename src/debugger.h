@@ -70,6 +70,8 @@ void debugger_shutdown();
 bool debugger_process();
 void debugger_render();
 bool debugger_active();
+bool debugger_stepping();
+const uint8_t *debugger_get_break_map();
 void debugger_print_char_to_console(uint8_t c);
 void debugger_reset_windows();
 void debugger_load_symbol_table(const std::string& filename);
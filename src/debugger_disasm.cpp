@@ -43,6 +43,7 @@
 #include "keyboard.h"
 #include "memory.h"
 #include "video.h"
+#include "machine.h"
 
 
 static std::regex Symtable_regex("\\s*[0x$]*([0-9A-Fa-f]{2,4})\\s+(\\w{1,8}).*");
@@ -152,7 +153,7 @@ uint8_t debugger_disasm::get_disassembly(uint16_t addr)
 	m_disassembly_line[0] = '\0';
 
 	// get the opcode at the address and from there we have the mode
-	cpu_6502::opcode_info *opcode = cpu.get_opcode(memory_read(addr, true));
+	cpu_6502::opcode_info *opcode = Machine->m_cpu.get_opcode(memory_read(addr, true));
 	if (opcode->m_mnemonic == '    ') {
 		// invalid opcode.  just print ?? and continue
 		strcpy(m_disassembly_line, "???");
@@ -263,8 +264,8 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 			} else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_DownArrow)) ||
 					(ImGui::IsWindowHovered() && io.MouseWheel < 0.0f)) {
 				// get opcode size and move to new address
-				cpu_6502::opcode_info *opcode = cpu.get_opcode(memory_read(m_current_addr));
-				if (cpu.get_opcode(memory_read(m_current_addr + opcode->m_size))->m_size > 0) {
+				cpu_6502::opcode_info *opcode = Machine->m_cpu.get_opcode(memory_read(m_current_addr));
+				if (Machine->m_cpu.get_opcode(memory_read(m_current_addr + opcode->m_size))->m_size > 0) {
 					new_addr = m_current_addr + opcode->m_size;
 				}
 				m_current_addr = new_addr;
@@ -331,14 +332,14 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 		ImGui::SetCursorPosY(5.0f);
 		ImGui::NewLine();
 		if (ImGui::CollapsingHeader("Registers", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_CollapsingHeader)) {
-			ImGui::Text("A  = $%02X", cpu.get_acc());
-			ImGui::Text("X  = $%02X", cpu.get_x());
-			ImGui::Text("Y  = $%02X", cpu.get_y());
-			ImGui::Text("PC = $%04X", cpu.get_pc());
-			ImGui::Text("SP = $%04X", cpu.get_sp() + 0x100);
+			ImGui::Text("A  = $%02X", Machine->m_cpu.get_acc());
+			ImGui::Text("X  = $%02X", Machine->m_cpu.get_x());
+			ImGui::Text("Y  = $%02X", Machine->m_cpu.get_y());
+			ImGui::Text("PC = $%04X", Machine->m_cpu.get_pc());
+			ImGui::Text("SP = $%04X", Machine->m_cpu.get_sp() + 0x100);
 
 			ImGui::NewLine();
-			uint8_t status = cpu.get_status();
+			uint8_t status = Machine->m_cpu.get_status();
 			ImGui::Text("%c%c%c%c%c%c%c%c\n%1d%1d%1d%1d%1d%1d%1d%1d = $%2x",
 				(status >> 7) & 1 ? 'S' : 's',
 				(status >> 6) & 1 ? 'V' : 'v',
@@ -362,7 +363,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 		ImGui::NewLine();
 
 		if (ImGui::CollapsingHeader("Soft Switches", ImGuiTreeNodeFlags_CollapsingHeader)) {
-			if (Memory_state & RAM_CARD_BANK2) { ImGui::Text("%-15s", "Bank1");
+			if (Memory->m_state & RAM_CARD_BANK2) { ImGui::Text("%-15s", "Bank1");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Bank2");
 			}
@@ -371,7 +372,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Bank2");
 			}
-			if (Memory_state & RAM_CARD_READ) {
+			if (Memory->m_state & RAM_CARD_READ) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "RCard Write");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "RCard Read");
@@ -381,7 +382,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "RCard Read");
 			}
-			if (Memory_state & RAM_AUX_MEMORY_READ) {
+			if (Memory->m_state & RAM_AUX_MEMORY_READ) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Main Read");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Aux Read");
@@ -391,7 +392,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Aux Read");
 			}
-			if (Memory_state & RAM_AUX_MEMORY_WRITE) {
+			if (Memory->m_state & RAM_AUX_MEMORY_WRITE) {
 				ImGui::Text("%-15s", "Main Write");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Aux Write");
@@ -401,7 +402,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Aux Write");
 			}
-			if (Memory_state & RAM_SLOTCX_ROM) {
+			if (Memory->m_state & RAM_SLOTCX_ROM) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Internal Rom");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Cx Rom");
@@ -411,7 +412,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Cx Rom");
 			}
-			if (Memory_state & RAM_ALT_ZERO_PAGE) {
+			if (Memory->m_state & RAM_ALT_ZERO_PAGE) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Zero Page");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Alt zp");
@@ -421,7 +422,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Alt zp");
 			}
-			if (Memory_state & RAM_SLOTC3_ROM) {
+			if (Memory->m_state & RAM_SLOTC3_ROM) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Internal Rom");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "C3 Rom");
@@ -431,7 +432,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "C3 Rom");
 			}
-			if (Memory_state & RAM_80STORE) {
+			if (Memory->m_state & RAM_80STORE) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Normal");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "80Store");
@@ -441,7 +442,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "80Store");
 			}
-			if (Video_mode & VIDEO_MODE_TEXT) {
+			if (Video->m_mode & VIDEO_MODE_TEXT) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Graphics");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Text");
@@ -451,7 +452,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Text");
 			}
-			if (Video_mode & VIDEO_MODE_MIXED) {
+			if (Video->m_mode & VIDEO_MODE_MIXED) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Not Mixed");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Mixed");
@@ -461,7 +462,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Mixed");
 			}
-			if (Video_mode & VIDEO_MODE_PAGE2) {
+			if (Video->m_mode & VIDEO_MODE_PAGE2) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Page 1");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Page 2");
@@ -471,7 +472,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Page 2");
 			}
-			if (Video_mode & VIDEO_MODE_HIRES) {
+			if (Video->m_mode & VIDEO_MODE_HIRES) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Lores");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Hires");
@@ -481,7 +482,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Hires");
 			}
-			if (Video_mode & VIDEO_MODE_ALTCHAR) {
+			if (Video->m_mode & VIDEO_MODE_ALTCHAR) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Reg char");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "Alt char");
@@ -491,7 +492,7 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Alt char");
 			}
-			if (Video_mode & VIDEO_MODE_80COL) {
+			if (Video->m_mode & VIDEO_MODE_80COL) {
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "40");
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::Text("%-15s", "80");
@@ -501,6 +502,31 @@ void debugger_disasm::draw(const char *title, uint16_t pc)
 				ImGui::SameLine(0.0f, 0.0f);
 				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "80");
 			}
+			if (Video->m_mode & VIDEO_MODE_DHIRES) {
+				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Single");
+				ImGui::SameLine(0.0f, 0.0f);
+				ImGui::Text("%-15s", "Double");
+			}
+			else {
+				ImGui::Text("%-15s", "Single");
+				ImGui::SameLine(0.0f, 0.0f);
+				ImGui::TextColored(style.Colors[ImGuiCol_TextDisabled], "%-15s", "Double");
+			}
+		}
+
+		ImGui::NewLine();
+
+		if (ImGui::CollapsingHeader("Paging", ImGuiTreeNodeFlags_CollapsingHeader)) {
+			ImGui::Text("%-10s%u", "Updates", Memory->m_paging_stats_last_frame.m_updates);
+			ImGui::Text("%-10s%u", "Skipped", Memory->m_paging_stats_last_frame.m_skipped);
+			ImGui::Text("%-10s%u", "Pages", Memory->m_paging_stats_last_frame.m_pages);
+		}
+
+		ImGui::NewLine();
+
+		if (ImGui::CollapsingHeader("Video (last second)", ImGuiTreeNodeFlags_CollapsingHeader)) {
+			ImGui::Text("%-10s%u/%u", "Skipped", Video->m_render_stats_last_second.m_frames_skipped, Video->m_render_stats_last_second.m_frames);
+			ImGui::Text("%-10s%u", "Lines", Video->m_render_stats_last_second.m_lines);
 		}
 
 		ImGui::NewLine();
@@ -590,7 +616,7 @@ void debugger_disasm::set_break_addr(uint16_t addr)
 	// address, reading the opcode from memory to fill in
 	// the opcode table
 	while (a < m_current_addr) {
-		cpu_6502::opcode_info *opcode = cpu.get_opcode(memory_read(a, true));
+		cpu_6502::opcode_info *opcode = Machine->m_cpu.get_opcode(memory_read(a, true));
 		if (opcode->m_size) {
 			a += opcode->m_size;
 		} else {
@@ -30,10 +30,15 @@ SOFTWARE.
 
 #include <algorithm>
 #include <iomanip>
+#include <string>
+#include <string.h>
+#include <vector>
 #include <SDL_log.h>
 #include "apple2emu.h"
 #include "disk.h"
+#include "machine.h"
 #include "memory.h"
+#include "snapshot.h"
 
 #if defined(max)
 #undef max
@@ -43,45 +48,15 @@ SOFTWARE.
 #undef min
 #endif
 
-class disk_drive {
-private:
-	uint8_t*     m_track_data;       // data read off of the disk put into this buffer
-	uint32_t     m_track_size;       // size of the sector data
-	uint32_t     m_last_read_cycle;  // last cycle count of a read
-	bool         m_motor_on;
-
-public:
-	disk_image* m_disk_image;       // holds information about the disk image
-	bool        m_write_mode;
-	bool        m_track_dirty;
-	uint8_t     m_phase_status;
-	uint8_t     m_half_track_count;
-	uint8_t     m_current_track;
-	uint8_t     m_data_register;    // data register from controller which holds bytes to/from disk
-	uint32_t    m_current_byte;
-
-public:
-	disk_drive() :m_disk_image(nullptr) {}
-	void init(bool warm_init);
-	void readwrite();
-	void set_new_track(uint8_t new_track);
-	bool insert_disk(const char *filename);
-	void eject_disk();
-    void motor_on(bool is_on);
-    bool is_motor_on() { return m_motor_on; }
-	uint8_t get_num_tracks();
-	const char *get_mounted_filename();
-};
 
+static const uint32_t Max_filename_length = 4096;
 
 // I NEED TO FIGURE OUT WHAT THIS DEFINE WORKS
 #define NIBBLES_PER_TRACK 0x1A00
 
-static const int Max_drives = 2;
 static const int Read_nibble_threashold = 6;  // 6 or less cycles on a read returns a nibble
 
-static disk_drive Disk_drives[Max_drives];
-static disk_drive *Current_drive;
+THREAD_LOCAL disk_state *Disk = nullptr;
 
 void disk_drive::init(bool warm_init)
 {
@@ -90,9 +65,6 @@ void disk_drive::init(bool warm_init)
 	m_track_dirty = false;
 	m_data_register = 0;
 	m_current_byte = 0;
-	if (m_track_data != nullptr) {
-		delete[] m_track_data;
-	}
 	m_track_data = nullptr;
 	m_track_size = 0;
 	m_last_read_cycle = 0;
@@ -108,33 +80,32 @@ void disk_drive::init(bool warm_init)
 
 void disk_drive::readwrite()
 {
-	if (m_track_data == nullptr) {
-		m_track_data = new uint8_t[10000];
-		if (m_track_data == nullptr) {
-			return;
-		}
-	}
-
-	// read the data out of the disk image into the track image
+	// get the nibbles for the track from the disk image
 	if (m_track_size == 0 && m_disk_image != nullptr) {
-		SDL_LogVerbose(LOG_CATEGORY_DISK, "track $%02x  read\n", Current_drive->m_current_track);
-		m_track_size = m_disk_image->read_track(Current_drive->m_current_track, m_track_data);
+		SDL_LogVerbose(LOG_CATEGORY_DISK, "track $%02x  read\n", m_current_track);
+		m_track_data = m_disk_image->get_track(m_current_track, m_track_size);
 		m_track_dirty = false;
 		m_current_byte = 0;
 	}
 
+	// no disk in the drive, so there is nothing to read or write
+	if (m_track_size == 0) {
+		m_data_register = 0;
+		return;
+	}
+
 	if (m_write_mode == false) {
 		// this is read mode
 		// There is a section in the DOS assembly called SAMESLOT which checks
 		// to see if the drive is up and spinning by reading the latch quickly.  We need
 		// to emulate this as without that, we hit massive delays in the assmebly code
 		// as it attemps to "wait" for the disk to be read
-		if (Total_cycles - m_last_read_cycle <= Read_nibble_threashold) {
+		if (Machine->m_total_cycles - m_last_read_cycle <= Read_nibble_threashold) {
 			m_data_register = m_track_data[m_current_byte] >> 4;
 			return;
 		}
 
-		m_last_read_cycle = Total_cycles;
+		m_last_read_cycle = Machine->m_total_cycles;
 		m_data_register = m_track_data[m_current_byte];
 		SDL_LogVerbose(LOG_CATEGORY_DISK, "Read: %04x %02x\n", m_current_byte, m_data_register);
 	}
@@ -155,22 +126,24 @@ void disk_drive::set_new_track(const uint8_t track)
 {
 	// write out old track if we are switching to a new track.
 	if (m_track_dirty == true && m_current_track != track && m_track_data != nullptr) {
-		m_disk_image->write_track(Current_drive->m_current_track, m_track_data);
+		m_disk_image->write_track(m_current_track, m_track_data);
 	}
 	m_current_track = track;
 
-	// get rid of the old sector data.  Need to do this a better way to avoid
-	// all the new/delete calls
-	delete[] m_track_data;
+	// the new track is picked up from the disk image on the next read
 	m_track_data = nullptr;
 	m_track_size = 0;
 }
 
-bool disk_drive::insert_disk(const char *filename)
+bool disk_drive::insert_disk(const char *filename, const bool save_changes)
 {
 	eject_disk();
 
 	m_disk_image = disk_image::load_image(filename);
+	if (m_disk_image == nullptr) {
+		return false;
+	}
+	m_disk_image->set_save_changes(save_changes);
 	return true;
 }
 
@@ -209,19 +182,100 @@ void disk_drive::motor_on(bool is_on)
     }
 }
 
+// the drive mechanics and the track under the head, including writes
+// to it that haven't made it back to the disk image yet.  The disk
+// image itself isn't saved, only which file is in the drive
+void disk_drive::save_state(snapshot_writer &writer)
+{
+	const char *filename = get_mounted_filename();
+	uint32_t filename_length = filename != nullptr ? static_cast<uint32_t>(strlen(filename)) : 0;
+	writer.write(filename_length);
+	writer.write_bytes(filename, filename_length);
+
+	writer.write(m_motor_on);
+	writer.write(m_last_read_cycle);
+	writer.write(m_write_mode);
+	writer.write(m_track_dirty);
+	writer.write(m_phase_status);
+	writer.write(m_half_track_count);
+	writer.write(m_current_track);
+	writer.write(m_data_register);
+	writer.write(m_current_byte);
+	writer.write(m_track_size);
+	writer.write_bytes(m_track_data, m_track_size);
+}
+
+void disk_drive::load_state(snapshot_reader &reader)
+{
+	uint32_t filename_length;
+	reader.read(filename_length);
+	if (filename_length > Max_filename_length) {
+		reader.set_error();
+		filename_length = 0;
+	}
+	std::string filename(filename_length, '\0');
+	reader.read_bytes(&filename[0], filename.size());
+
+	// swap disks if a different one was in the drive
+	const char *mounted = get_mounted_filename();
+	if (filename.empty()) {
+		eject_disk();
+	} else if (mounted == nullptr || filename != mounted) {
+		if (insert_disk(filename.c_str(), true) == false) {
+			printf("Unable to load disk image %s for save state\n", filename.c_str());
+		}
+	}
+
+	reader.read(m_motor_on);
+	reader.read(m_last_read_cycle);
+	reader.read(m_write_mode);
+	reader.read(m_track_dirty);
+	reader.read(m_phase_status);
+	reader.read(m_half_track_count);
+	reader.read(m_current_track);
+	reader.read(m_data_register);
+	reader.read(m_current_byte);
+	reader.read(m_track_size);
+	if (m_track_size > Track_buffer_size || (m_track_size != 0 && m_current_byte >= m_track_size)) {
+		reader.set_error();
+		m_track_size = 0;
+	}
+
+	// the saved nibbles go over the disk image's copy of the track.  That
+	// copy is rebuilt from the image the next time the track is read, the
+	// same as if the drive had written to it
+	uint32_t track_size = m_track_size;
+	m_track_data = nullptr;
+	if (m_disk_image != nullptr && track_size != 0) {
+		m_track_data = m_disk_image->get_track(m_current_track, m_track_size);
+		m_disk_image->invalidate_track(m_current_track);
+	}
+	if (m_track_data != nullptr) {
+		m_track_size = track_size;
+		reader.read_bytes(m_track_data, m_track_size);
+	} else {
+		// without a disk image there is nothing to write the track back to
+		std::vector<uint8_t> skipped(track_size);
+		reader.read_bytes(skipped.data(), skipped.size());
+		m_track_size = 0;
+		m_track_dirty = false;
+	}
+}
+
 // inserts a disk image into the given slot
-bool disk_insert(const char *disk_image_filename, const uint32_t slot)
+bool disk_insert(const char *disk_image_filename, const uint32_t slot, const bool save_changes)
 {
-	Disk_drives[slot - 1].insert_disk(disk_image_filename);
-	return true;
+	return Disk->m_drives[slot - 1].insert_disk(disk_image_filename, save_changes);
 }
 
 void disk_eject(const uint32_t slot)
 {
-	Disk_drives[slot - 1].eject_disk();
+	Disk->m_drives[slot - 1].eject_disk();
 }
 
-uint8_t drive_handler(uint16_t addr, uint8_t val, bool write)
+// handles the disk controller soft switches.  The disk state is the
+// context the card was registered with
+static uint8_t drive_handler(disk_state *disk, uint16_t addr, uint8_t val, bool write)
 {
 	uint8_t action = (addr & 0x000f);
 
@@ -240,10 +294,10 @@ uint8_t drive_handler(uint16_t addr, uint8_t val, bool write)
 			uint8_t phase = (addr >> 1) & 3;	   // gets which motor, 0, 1, 2, or 3
 
 			if (addr & 1) {
-				Current_drive->m_phase_status |= (1 << phase);
+				disk->m_current_drive->m_phase_status |= (1 << phase);
 			}
 			else {
-				Current_drive->m_phase_status &= ~(1 << phase);
+				disk->m_current_drive->m_phase_status &= ~(1 << phase);
 			}
 
 			// step in (increment) to new track.  phase 1, then phase 2
@@ -254,26 +308,26 @@ uint8_t drive_handler(uint16_t addr, uint8_t val, bool write)
 			// 2 from even numbered track.  Phase 1, then phase 0
 			// from odd numbered track.
 			int dir = 0;
-			if (Current_drive->m_phase_status & (1 << ((Current_drive->m_half_track_count + 1) & 3))) {
+			if (disk->m_current_drive->m_phase_status & (1 << ((disk->m_current_drive->m_half_track_count + 1) & 3))) {
 				dir = 1;
 			}
-			if (Current_drive->m_phase_status & (1 << ((Current_drive->m_half_track_count + 3) & 3))) {
+			if (disk->m_current_drive->m_phase_status & (1 << ((disk->m_current_drive->m_half_track_count + 3) & 3))) {
 				dir = -1;
 			}
 
 			if (dir != 0) {
-				Current_drive->m_half_track_count = static_cast<uint8_t>(std::max(0, std::min(79, Current_drive->m_half_track_count + dir)));
-				uint8_t new_track = static_cast<uint8_t>(std::min(Current_drive->get_num_tracks() - 1, Current_drive->m_half_track_count >> 1));
-				if (new_track != Current_drive->m_current_track) {
-					Current_drive->set_new_track(new_track);
+				disk->m_current_drive->m_half_track_count = static_cast<uint8_t>(std::max(0, std::min(79, disk->m_current_drive->m_half_track_count + dir)));
+				uint8_t new_track = static_cast<uint8_t>(std::min(disk->m_current_drive->get_num_tracks() - 1, disk->m_current_drive->m_half_track_count >> 1));
+				if (new_track != disk->m_current_drive->m_current_track) {
+					disk->m_current_drive->set_new_track(new_track);
 				}
 			}
 			SDL_LogVerbose(LOG_CATEGORY_DISK, "phases: %1x%1x%1x%1x track: %02x dir: %1x addr: %02x\n",
-				((Current_drive->m_phase_status >> 3) & 0x1),
-				((Current_drive->m_phase_status >> 2) & 0x1),
-				((Current_drive->m_phase_status >> 1) & 0x1),
-				(Current_drive->m_phase_status & 0x1),
-				(int)Current_drive->m_half_track_count,
+				((disk->m_current_drive->m_phase_status >> 3) & 0x1),
+				((disk->m_current_drive->m_phase_status >> 2) & 0x1),
+				((disk->m_current_drive->m_phase_status >> 1) & 0x1),
+				(disk->m_current_drive->m_phase_status & 0x1),
+				(int)disk->m_current_drive->m_half_track_count,
 				dir,
 				(addr & 0xff));
 		}
@@ -283,23 +337,23 @@ uint8_t drive_handler(uint16_t addr, uint8_t val, bool write)
 	case 0x8:
 	case 0x9:
 		// turn the motor on or off
-		Current_drive->motor_on(addr & 1);
+		disk->m_current_drive->motor_on(addr & 1);
 		break;
 
 	case 0xa:
 	case 0xb:
 		// pick a specific drive
 		if (((addr & 0xf) - 0xa) == 0) {
-			Current_drive = &Disk_drives[0];
+			disk->m_current_drive = &disk->m_drives[0];
 		}
 		else {
-			Current_drive = &Disk_drives[1];
+			disk->m_current_drive = &disk->m_drives[1];
 		}
 		SDL_LogVerbose(LOG_CATEGORY_DISK, "Select drive: %1d\n", (addr & 0xf) - 0x9);
 		break;
 
 	case 0xc:
-		Current_drive->readwrite();
+		disk->m_current_drive->readwrite();
 		break;
 
 	case 0xd:
@@ -307,68 +361,102 @@ uint8_t drive_handler(uint16_t addr, uint8_t val, bool write)
 		// we would or a high bit into the data register as this bit
 		// is used to determine write protect status.  Removing
 		// the high bit forces the QA bit low which enables writing
-		if (Current_drive->m_disk_image->read_only() == true) {
-			Current_drive->m_data_register |= 0x80;
+		if (disk->m_current_drive->m_disk_image->read_only() == true) {
+			disk->m_current_drive->m_data_register |= 0x80;
 		}
 		else {
-			Current_drive->m_data_register &= 0x7f;
+			disk->m_current_drive->m_data_register &= 0x7f;
 		}
 		break;
 
 	case 0xe:
-		Current_drive->m_write_mode = false;
+		disk->m_current_drive->m_write_mode = false;
 		break;
 
 	case 0xf:
-		Current_drive->m_write_mode = true;
+		disk->m_current_drive->m_write_mode = true;
 		break;
 	}
 
 	if (write == true) {
-		Current_drive->m_data_register = val;
+		disk->m_current_drive->m_data_register = val;
 	}
 
 	if (!(addr & 0x1)) {
-		return Current_drive->m_data_register;
+		return disk->m_current_drive->m_data_register;
 	}
 
 	return 0;
 
 }
 
+static uint8_t drive_read(void *context, uint16_t addr)
+{
+	return drive_handler(static_cast<disk_state *>(context), addr, 0, false);
+}
+
+static void drive_write(void *context, uint16_t addr, uint8_t val)
+{
+	drive_handler(static_cast<disk_state *>(context), addr, val, true);
+}
+
 // initialize the disk system
 void disk_init()
 {
-	memory_register_slot_handler(6, drive_handler);
+	slot_device disk_card = {};
+	disk_card.m_io_read = drive_read;
+	disk_card.m_io_write = drive_write;
+	disk_card.m_context = Disk;
+	memory_register_slot_handler(6, disk_card);
 	for (int i = 0; i < Max_drives; i++) {
-		Disk_drives[i].init(false);
+		Disk->m_drives[i].init(false);
 	}
-	Current_drive = &Disk_drives[0];
+	Disk->m_current_drive = &Disk->m_drives[0];
 }
 
 void disk_shutdown()
 {
+	// the drives go away with the machine, so let go of the track
+	// buffers along with the images
 	for (int i = 0; i < Max_drives; i++) {
-		if (Disk_drives[i].m_disk_image != nullptr) {
-			delete Disk_drives[i].m_disk_image;
-		}
+		Disk->m_drives[i].eject_disk();
 	}
+	disk_image::wait_for_writes();
 }
 
 // return the filename of the mounted disk in the given slot
 const char *disk_get_mounted_filename(const uint32_t slot)
 {
-	return Disk_drives[slot - 1].get_mounted_filename();
+	return Disk->m_drives[slot - 1].get_mounted_filename();
 }
 
 bool disk_is_on(const uint32_t slot)
 {
-	return Disk_drives[slot - 1].is_motor_on();
+	return Disk->m_drives[slot - 1].is_motor_on();
 }
 
 bool disk_get_track_and_sector(uint32_t slot, uint32_t &track, uint32_t &sector)
 {
-	track = Disk_drives[slot - 1].m_current_track;
-	sector = Disk_drives[slot - 1].m_current_byte / 256;
+	track = Disk->m_drives[slot - 1].m_current_track;
+	sector = Disk->m_drives[slot - 1].m_current_byte / 256;
 	return true;
 }
+
+void disk_save_state(snapshot_writer &writer)
+{
+	for (int i = 0; i < Max_drives; i++) {
+		Disk->m_drives[i].save_state(writer);
+	}
+	uint8_t current_drive = static_cast<uint8_t>(Disk->m_current_drive - Disk->m_drives);
+	writer.write(current_drive);
+}
+
+void disk_load_state(snapshot_reader &reader)
+{
+	for (int i = 0; i < Max_drives; i++) {
+		Disk->m_drives[i].load_state(reader);
+	}
+	uint8_t current_drive;
+	reader.read(current_drive);
+	Disk->m_current_drive = &Disk->m_drives[current_drive < Max_drives ? current_drive : 0];
+}
@@ -28,14 +28,65 @@ SOFTWARE.
 #pragma once
 
 // class for disk drive.  Represents physical drive
+#include "apple2emu_defs.h"
 #include "disk_image.h"
 #include "path_utils.h"
 
+class snapshot_writer;
+class snapshot_reader;
+
+class disk_drive {
+private:
+	uint8_t*     m_track_data;       // nibbles of the track under the head (owned by the disk image)
+	uint32_t     m_track_size;       // size of the sector data
+	uint64_t     m_last_read_cycle;  // last cycle count of a read
+	bool         m_motor_on;
+
+public:
+	disk_image* m_disk_image;       // holds information about the disk image
+	bool        m_write_mode;
+	bool        m_track_dirty;
+	uint8_t     m_phase_status;
+	uint8_t     m_half_track_count;
+	uint8_t     m_current_track;
+	uint8_t     m_data_register;    // data register from controller which holds bytes to/from disk
+	uint32_t    m_current_byte;
+
+public:
+	disk_drive() :m_track_data(nullptr), m_disk_image(nullptr) {}
+	void init(bool warm_init);
+	void readwrite();
+	void set_new_track(uint8_t new_track);
+	bool insert_disk(const char *filename, const bool save_changes);
+	void eject_disk();
+    void motor_on(bool is_on);
+    bool is_motor_on() { return m_motor_on; }
+	uint8_t get_num_tracks();
+	const char *get_mounted_filename();
+	void save_state(snapshot_writer &writer);
+	void load_state(snapshot_reader &reader);
+};
+
+static const int Max_drives = 2;
+
+// the disk controller card of one machine (see machine.h)
+struct disk_state {
+	disk_drive  m_drives[Max_drives];
+	disk_drive *m_current_drive;
+};
+
+// disk drives of the machine running on this thread
+extern THREAD_LOCAL disk_state *Disk;
+
 void disk_init();
 void disk_shutdown();
-bool disk_insert(const char *disk_image_filename, const uint32_t slot);
+// save_changes false keeps writes to the disk in memory only, so the
+// image file is never changed
+bool disk_insert(const char *disk_image_filename, const uint32_t slot, const bool save_changes = true);
 void disk_eject(const uint32_t slot);
 const char *disk_get_mounted_filename(const uint32_t slot);
 bool disk_is_on(const uint32_t slot);
 bool disk_get_track_and_sector(uint32_t slot, uint32_t &track, uint32_t &sector);
+void disk_save_state(snapshot_writer &writer);
+void disk_load_state(snapshot_reader &reader);
 
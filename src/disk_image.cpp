@@ -32,10 +32,18 @@ SOFTWARE.
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #if defined(_WIN32)
 #include <io.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 #include "apple2emu_defs.h"
@@ -60,14 +68,111 @@ const uint8_t disk_image::m_prodos_block_map[][2] =
 	{ 0xd, 0xf },
 };
 
+// changes to disk images are written out on a thread of their own so
+// that the emulation never waits on the file system.  A job is the
+// changed pieces of one image, copied at the time of the save.  Jobs are
+// written in order, so later saves of an image land on top of earlier ones
+struct disk_write_run {
+	size_t               m_offset;
+	std::vector<uint8_t> m_data;
+};
+
+struct disk_write_job {
+	std::string                 m_filename;
+	std::vector<disk_write_run> m_runs;
+};
+
+class disk_writer {
+private:
+	std::mutex                 m_mutex;
+	std::condition_variable    m_wake;       // signalled when there is a job or it is time to quit
+	std::condition_variable    m_idle;       // signalled when the queue has been written
+	std::deque<disk_write_job> m_jobs;
+	std::thread                m_thread;
+	bool                       m_busy = false;
+	bool                       m_quit = false;
+
+	static void write_job(const disk_write_job &job)
+	{
+		// the file is updated in place rather than written from scratch
+		FILE *fp = fopen(job.m_filename.c_str(), "r+b");
+		if (fp == nullptr) {
+			printf("Unable to save disk image %s\n", job.m_filename.c_str());
+			return;
+		}
+		for (auto &run : job.m_runs) {
+			if (fseek(fp, long(run.m_offset), SEEK_SET) != 0 ||
+				fwrite(run.m_data.data(), 1, run.m_data.size(), fp) != run.m_data.size()) {
+				printf("Didn't write out full image!\n");
+				break;
+			}
+		}
+		fclose(fp);
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true) {
+			m_wake.wait(lock, [this] { return m_quit || m_jobs.empty() == false; });
+			if (m_jobs.empty()) {
+				return;
+			}
+			disk_write_job job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_busy = true;
+			lock.unlock();
+			write_job(job);
+			lock.lock();
+			m_busy = false;
+			if (m_jobs.empty()) {
+				m_idle.notify_all();
+			}
+		}
+	}
+
+public:
+	~disk_writer()
+	{
+		// anything still queued is written before the program exits
+		if (m_thread.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_quit = true;
+			}
+			m_wake.notify_one();
+			m_thread.join();
+		}
+	}
+
+	void queue(disk_write_job &&job)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_thread.joinable() == false) {
+			m_thread = std::thread(&disk_writer::run, this);
+		}
+		m_jobs.push_back(std::move(job));
+		m_wake.notify_one();
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this] { return m_jobs.empty() && m_busy == false; });
+	}
+};
+
+static disk_writer Disk_writer;
+
 // destructor for a diskimage.  Make sure the
 // image is saved before deleting it
 disk_image::~disk_image()
 {
 	// save the image if we have written to it
 	save_image();
-	if (m_raw_buffer != nullptr) {
-		delete[] m_raw_buffer;
+	delete m_storage;
+	for (uint32_t track = 0; track < m_total_tracks; track++) {
+		delete[] m_track_cache[track];
 	}
 }
 
@@ -76,35 +181,150 @@ const char *disk_image::get_filename()
 	return m_filename.c_str();
 }
 
+// get the nibbles for a track, building them if they aren't cached.  The
+// buffer belongs to the image and stays put for as long as the image is
+// loaded, so a drive can read and write it in place
+uint8_t *disk_image::get_track(const uint32_t track, uint32_t &size)
+{
+	size = 0;
+	if (track >= m_num_tracks || track >= m_total_tracks) {
+		return nullptr;
+	}
+
+	if (m_track_cache[track] == nullptr) {
+		m_track_cache[track] = new uint8_t[Track_buffer_size];
+	}
+	if (m_track_cache_size[track] == 0) {
+		m_track_cache_size[track] = read_track(track, m_track_cache[track]);
+	}
+	size = m_track_cache_size[track];
+	return m_track_cache[track];
+}
+
+// the nibbles for the track get built again on the next read.  Drives
+// still reading the old ones are left alone
+void disk_image::invalidate_track(const uint32_t track)
+{
+	if (track < m_total_tracks) {
+		m_track_cache_size[track] = 0;
+	}
+}
+
 
 void disk_image::init()
 {
+	m_storage = nullptr;
 	m_raw_buffer = nullptr;
 	m_filename.clear();
 }
 
-// load an image from disk.  Read the entirety
-// of the image into local memory.  Makes
-// reading and writing super fast since we do it
-// straight to memory
-disk_image *disk_image::load_image(const char *filename)
+memory_image_storage::~memory_image_storage()
+{
+	delete[] m_data;
+}
+
+bool memory_image_storage::load(const char *filename)
 {
-	// load disk into buffer
 	FILE *fp = fopen(filename, "rb");
 	if (fp == nullptr) {
-		return nullptr;
+		return false;
 	}
 
 	fseek(fp, 0, SEEK_END);
-	uint32_t buffer_size = ftell(fp);
+	long size = ftell(fp);
 	fseek(fp, 0, SEEK_SET);
+	if (size <= 0) {
+		fclose(fp);
+		return false;
+	}
 
-	// allocate the whole buffer - in modern systems we
-	// can just load these things up and not really worry
-	// about memory usage here
-	uint8_t *raw_buffer = (uint8_t *)new uint8_t[buffer_size];
-	fread(raw_buffer, 1, buffer_size, fp);
+	m_size = size_t(size);
+	m_data = new uint8_t[m_size];
+	size_t num_read = fread(m_data, 1, m_size, fp);
 	fclose(fp);
+	return num_read == m_size;
+}
+
+#if defined(_WIN32)
+
+// no mapping on windows yet.  open() falls back to reading the file in
+mapped_image_storage::~mapped_image_storage()
+{
+}
+
+bool mapped_image_storage::map(const char *filename)
+{
+	UNREFERENCED(filename);
+	return false;
+}
+
+#else
+
+mapped_image_storage::~mapped_image_storage()
+{
+	if (m_data != nullptr) {
+		munmap(m_data, m_size);
+	}
+}
+
+bool mapped_image_storage::map(const char *filename)
+{
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || size_t(info.st_size) < m_min_size) {
+		close(fd);
+		return false;
+	}
+
+	// a private mapping can be written to even though the file is only
+	// open for reading.  The mapping holds on to the file once it is made
+	void *data = mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	m_data = static_cast<uint8_t *>(data);
+	m_size = size_t(info.st_size);
+	return true;
+}
+
+#endif
+
+// map the file if it is a large volume, otherwise read it all in
+disk_image_storage *disk_image_storage::open(const char *filename)
+{
+	mapped_image_storage *mapped = new mapped_image_storage();
+	if (mapped->map(filename)) {
+		return mapped;
+	}
+	delete mapped;
+
+	memory_image_storage *memory = new memory_image_storage();
+	if (memory->load(filename)) {
+		return memory;
+	}
+	delete memory;
+	return nullptr;
+}
+
+// load an image from disk.  The image is mapped (or read in) as a
+// whole so that reading and writing it is done straight to memory
+disk_image *disk_image::load_image(const char *filename)
+{
+	// the image may have just been ejected with changes that are still
+	// on their way out to the file
+	Disk_writer.wait();
+
+	disk_image_storage *storage = disk_image_storage::open(filename);
+	if (storage == nullptr) {
+		return nullptr;
+	}
+	size_t buffer_size = storage->size();
 
 	// determine read-only access for the file
 	bool read_only = false;
@@ -130,48 +350,94 @@ disk_image *disk_image::load_image(const char *filename)
 		}
 	}
 
-	if (new_image != nullptr) {
-        new_image->m_read_only = read_only;
-		new_image->m_raw_buffer = raw_buffer;
-		new_image->m_buffer_size = buffer_size;
-		new_image->m_filename = filename;
-		new_image->m_volume_num = 254;
-		new_image->m_image_dirty = false;
-		new_image->initialize_image();
+	if (new_image == nullptr) {
+		delete storage;
+		return nullptr;
 	}
 
+	new_image->m_read_only = read_only;
+	new_image->m_storage = storage;
+	new_image->m_raw_buffer = storage->data();
+	new_image->m_buffer_size = buffer_size;
+	new_image->m_filename = filename;
+	new_image->m_volume_num = 254;
+	new_image->m_image_dirty = false;
+	new_image->m_dirty_chunks.assign((buffer_size + m_write_chunk_size - 1) / m_write_chunk_size, false);
+	new_image->m_save_changes = true;
+	for (uint32_t track = 0; track < m_total_tracks; track++) {
+		new_image->m_track_cache[track] = nullptr;
+		new_image->m_track_cache_size[track] = 0;
+	}
+	new_image->initialize_image();
 
 	return new_image;
 }
 
-// save a disk image (if needed).  This will write out the entire disk
-// image which is stored in memory
+// save a disk image (if needed).  The pieces of the image that have
+// changed are handed to the writer thread
 bool disk_image::save_image()
 {
-	if (m_image_dirty == true) {
-		FILE *fp = fopen(m_filename.c_str(), "wb");
-		if (fp == nullptr) {
+	if (m_image_dirty == true && m_save_changes == true) {
+		if (m_read_only) {
 			return false;
 		}
-		size_t num_written = fwrite(m_raw_buffer, 1, m_buffer_size, fp);
-		fclose(fp);
-		if (num_written != m_buffer_size) {
-			printf("Didn't write out full image!\n");
+
+		// copy out runs of changed pieces for the writer thread
+		disk_write_job job;
+		job.m_filename = m_filename;
+		size_t num_chunks = m_dirty_chunks.size();
+		for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+			if (m_dirty_chunks[chunk] == false) {
+				continue;
+			}
+			size_t end = chunk;
+			while (end < num_chunks && m_dirty_chunks[end]) {
+				m_dirty_chunks[end] = false;
+				end++;
+			}
+			size_t offset = chunk * m_write_chunk_size;
+			size_t size = std::min(end * m_write_chunk_size, m_buffer_size) - offset;
+			job.m_runs.push_back({ offset, std::vector<uint8_t>(m_raw_buffer + offset, m_raw_buffer + offset + size) });
+			chunk = end;
 		}
+		Disk_writer.queue(std::move(job));
 		m_image_dirty = false;
 	}
 	return true;
 }
 
+// wait for the writer thread to finish saving what it has been given
+void disk_image::wait_for_writes()
+{
+	Disk_writer.wait();
+}
+
+// copy data into the image, marking the pieces that actually change so
+// that they get saved
+void disk_image::write_raw(const size_t offset, const uint8_t *data, const size_t size)
+{
+	size_t end = std::min(offset + size, m_buffer_size);
+	for (size_t pos = offset; pos < end; ) {
+		size_t chunk = pos / m_write_chunk_size;
+		size_t chunk_end = std::min((chunk + 1) * m_write_chunk_size, end);
+		if (memcmp(&m_raw_buffer[pos], &data[pos - offset], chunk_end - pos) != 0) {
+			memcpy(&m_raw_buffer[pos], &data[pos - offset], chunk_end - pos);
+			m_dirty_chunks[chunk] = true;
+			m_image_dirty = true;
+		}
+		pos = chunk_end;
+	}
+}
+
 // unload a disk image.  Called when a new disk is inserted.  This call will
 // clean up the image (saving if necessary)
 bool disk_image::unload_image()
 {
 	// save the image if we have written to it
 	save_image();
-	if (m_raw_buffer != nullptr) {
-		delete[] m_raw_buffer;
-	}
+	delete m_storage;
+	m_storage = nullptr;
+	m_raw_buffer = nullptr;
 	m_filename.clear();
 
 	return true;
@@ -399,7 +665,8 @@ bool disk_image::denibbilize_track(const int track, uint8_t *buffer)
 		uint8_t encoded_sector = (*work_ptr & 0x55) << 1 | (*(work_ptr + 1) & 0x55);
 		work_ptr += 2;
 		uint8_t mapped_sector = m_sector_map[static_cast<uint8_t>(m_format)][encoded_sector];
-		uint8_t *sector_ptr = &track_ptr[mapped_sector * m_sector_bytes];
+		size_t sector_offset = (track_ptr - m_raw_buffer) + mapped_sector * m_sector_bytes;
+		uint8_t sector_data[m_sector_bytes];
 
 		work_ptr += 2;  // skip past the checksum
 		work_ptr += 3;  // skip past the epilogue
@@ -439,12 +706,13 @@ bool disk_image::denibbilize_track(const int track, uint8_t *buffer)
 		// 6 bit bytes are stored.  These will be combined with the bits in the first 0x56 bytes to
 		// form the true 256 bytes for storage
 		for (auto byte_num = 0; byte_num < 0x56; byte_num++) {
-			sector_ptr[byte_num] = (nib_data[byte_num + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x08) >> 3) | ((nib_data[byte_num] & 0x04) >> 1);
-			sector_ptr[byte_num + 0x56] = (nib_data[byte_num + 0x56 + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x20) >> 5) | ((nib_data[byte_num] & 0x10) >> 3);
+			sector_data[byte_num] = (nib_data[byte_num + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x08) >> 3) | ((nib_data[byte_num] & 0x04) >> 1);
+			sector_data[byte_num + 0x56] = (nib_data[byte_num + 0x56 + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x20) >> 5) | ((nib_data[byte_num] & 0x10) >> 3);
 			if (byte_num + 0xac < 0x100) {
-				sector_ptr[byte_num + 0xac] = (nib_data[byte_num + 0xac + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x80) >> 7) | ((nib_data[byte_num] & 0x40) >> 5);
+				sector_data[byte_num + 0xac] = (nib_data[byte_num + 0xac + 0x56] & 0xfc) | ((nib_data[byte_num] & 0x80) >> 7) | ((nib_data[byte_num] & 0x40) >> 5);
 			}
 		}
+		write_raw(sector_offset, sector_data, m_sector_bytes);
 	}
 
 	return true;
@@ -460,7 +728,7 @@ bool dsk_image::write_track(const uint32_t track, uint8_t *buffer)
 {
 	// denybbilze track data stored in buffer to the work buffer
 	// and then store that work buffer into the loaded disk image
-	m_image_dirty = true;
+	invalidate_track(track);
 	return denibbilize_track(track, buffer);
 }
 
@@ -488,8 +756,7 @@ uint32_t nib_image::read_track(const uint32_t track, uint8_t *buffer) {
 bool nib_image::write_track(const uint32_t track, uint8_t *buffer)
 {
 	uint32_t num_bytes = m_total_sectors * m_sector_bytes;
-	uint8_t *track_ptr = &m_raw_buffer[track * num_bytes];
-    memcpy(track_ptr, buffer, num_bytes);
+	write_raw(track * num_bytes, buffer, num_bytes);
 	return true;
 }
 
@@ -515,7 +782,7 @@ bool po_image::write_track(const uint32_t track, uint8_t *buffer)
 {
 	// denybbilze track data stored in buffer to the work buffer
 	// and then store that work buffer into the loaded disk image
-	m_image_dirty = true;
+	invalidate_track(track);
 	return denibbilize_track(track, buffer);
 }
 
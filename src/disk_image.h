@@ -32,6 +32,52 @@ SOFTWARE.
 #pragma once
 
 #include <string>
+#include <vector>
+
+// size of the buffer holding one track worth of nibbles
+static const uint32_t Track_buffer_size = 10000;
+
+// where the bytes of a disk image live while it is mounted.  Either read
+// into memory or mapped from the file
+class disk_image_storage
+{
+protected:
+	uint8_t*         m_data;
+	size_t           m_size;
+
+public:
+	disk_image_storage() : m_data(nullptr), m_size(0) {}
+	virtual ~disk_image_storage() {}
+	uint8_t *data() { return m_data; }
+	size_t size() { return m_size; }
+
+	static disk_image_storage *open(const char *filename);
+};
+
+// the whole file read into a buffer
+class memory_image_storage : public disk_image_storage
+{
+public:
+	virtual ~memory_image_storage();
+	bool load(const char *filename);
+};
+
+// the file mapped copy-on-write, for large volumes only.  Mounting is the
+// same cost whatever the size of the image and only the parts that are
+// used get read in.  Changes stay in memory until the image is saved like
+// any other.  The catch is that the file has to stay as it is while it is
+// mounted: if another program truncates it, touching the missing part
+// crashes with SIGBUS, and pages not yet touched may pick up changes made
+// to the file (including our own saves).  Floppies are small enough to
+// read in, so they never take that risk
+class mapped_image_storage : public disk_image_storage
+{
+public:
+	static const size_t m_min_size = 1024 * 1024;   // smaller images are read in
+
+	virtual ~mapped_image_storage();
+	bool map(const char *filename);
+};
 
 class disk_image
 {
@@ -52,18 +98,27 @@ protected:
 
 	std::string      m_filename;
 	bool             m_image_dirty;
+	std::vector<bool> m_dirty_chunks;  // which m_write_chunk_size pieces of the image need saving
 	bool             m_read_only;
+	bool             m_save_changes;   // write the image back to the file when it changes
 
 	disk_image() {};
 
 	static const uint8_t m_sector_map[static_cast<uint8_t>(format_type::NUM_FORMATS)][16];
 	static const uint8_t m_prodos_block_map[8][2];
 
-	uint8_t*         m_raw_buffer;
+	disk_image_storage* m_storage;
+	uint8_t*         m_raw_buffer;      // the bytes of the image, from m_storage
 	size_t           m_buffer_size;
 	uint8_t          m_volume_num;
 	format_type      m_format;
 
+	// nibbles for each track.  Built the first time the track is read and
+	// again after the track is written, so that seeking back and forth
+	// doesn't nibbilize the same tracks over and over
+	uint8_t*         m_track_cache[m_total_tracks];
+	uint32_t         m_track_cache_size[m_total_tracks];   // 0 when the track needs to be built
+
 	// used for some formats that need to get nibbilized and denibbilized
 	static const uint8_t m_write_translate_table[64];
 	static const uint8_t m_read_translate_table[128];
@@ -72,8 +127,13 @@ protected:
 	static const uint32_t m_gap2_num_bytes = 6;
 	static const uint32_t m_gap3_num_bytes = 27;
 
+	// images are saved in pieces this size, so only the sectors that
+	// were written go back out to the file
+	static const uint32_t m_write_chunk_size = 256;
+
 	uint32_t nibbilize_track(const int track, uint8_t *buffer);
 	bool denibbilize_track(const int track, uint8_t *buffer);
+	void write_raw(const size_t offset, const uint8_t *data, const size_t size);
 
 public:
 
@@ -88,8 +148,12 @@ public:
 	void init();
 	bool save_image();
 	bool unload_image();
+	static void wait_for_writes();
 	bool read_only() { return m_read_only; }
+	void set_save_changes(bool save_changes) { m_save_changes = save_changes; }
 	const char *get_filename();
+	uint8_t *get_track(const uint32_t track, uint32_t &size);
+	void invalidate_track(const uint32_t track);
 
 	// functions for derived classes
 	virtual uint32_t read_track(const uint32_t track, uint8_t* buffer) = 0;
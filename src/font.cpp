@@ -32,8 +32,6 @@ SOFTWARE.
 #include <stdio.h>
 
 #include "SDL.h"
-#include "SDL_opengl.h"
-#include "SDL_image.h"
 
 #include "apple2emu_defs.h"
 #include "font.h"
@@ -62,22 +60,16 @@ bool font::load(const char *filename)
 	fread(&m_header.m_char_widths, sizeof(uint8_t), 256, fp);
 
 	// now read the pixels
+	// the pixels stay in memory.  The screen is decoded from them
+	// on the cpu side
 	int num_pixels = m_header.m_bitmap_width * m_header.m_bitmap_height * (m_header.m_bpp / 8);
-	uint8_t *pixels = new uint8_t[num_pixels];
-	fread(pixels, num_pixels, 1, fp);
+	delete[] m_pixels;
+	m_pixels = new uint8_t[num_pixels];
+	fread(m_pixels, num_pixels, 1, fp);
 	fclose(fp);
 
 	SDL_assert((m_header.m_id[0] == 0xbf) && (m_header.m_id[1] == 0xf2));
 
-	// load the pixels into a GL texture
-	glGenTextures(1, &m_texture_id);
-	glBindTexture(GL_TEXTURE_2D, m_texture_id);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_header.m_bitmap_width, m_header.m_bitmap_height, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
-
 	// set up font information on cells and locations for characters
 	//
 	// I used CBFG to generate the fonts.  it was a TTF to bitmap font generator
@@ -87,11 +79,6 @@ bool font::load(const char *filename)
 	// http://www.codehead.co.uk/cbfg/
 	//
 
-	// uv widths and heights for the cells - they are all fixed so this
-	// is a fixed value
-	m_cell_u = (float)m_header.m_cell_width / (float)m_header.m_bitmap_width;
-	m_cell_v = (float)m_header.m_cell_height / (float)m_header.m_bitmap_height;
-
 	uint32_t chars_per_row = m_header.m_bitmap_width / m_header.m_cell_width;
 
 	// calculate rects for characters in the font.  These things here will be 0
@@ -100,16 +87,8 @@ bool font::load(const char *filename)
 		uint32_t character_row = i / chars_per_row;
 		uint32_t character_col = i - character_row * chars_per_row;
 
-		m_char_u[i] = character_col * m_cell_u;
-		m_char_v[i] = character_row * m_cell_v;
-	}
-
-	// I had this in here when getting 80 column mode running because
-	// we had to have widths of 7, but I think that with the new
-	// way of loading fonts and rendering (to 560x380), this isn't necessary
-	// anymore for some reason
-	if (m_header.m_cell_width == 8) {
-		m_cell_u -= 1.0f / m_header.m_bitmap_width;
+		m_char_x[i] = character_col * m_header.m_cell_width;
+		m_char_y[i] = character_row * m_header.m_cell_height;
 	}
 
 	return true;
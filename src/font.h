@@ -56,17 +56,20 @@ public:
 	};
 
 		
-	uint8_t    m_format;
-	float      m_cell_u;
-	float      m_cell_v;
-
 	header        m_header;
-	GLuint        m_texture_id;
+	uint8_t      *m_pixels;      // bitmap sheet, kept in memory for the software renderer
 
-	float         m_char_u[256];
-	float         m_char_v[256];
+	uint32_t      m_char_x[256];  // location of each character in the bitmap sheet
+	uint32_t      m_char_y[256];
 
-	font() { }
+	font() : m_pixels(nullptr) { }
+	~font() { delete[] m_pixels; }
 	bool load(const char *filename);
 
+	// returns true if the pixel at x, y in the cell for character c is lit
+	bool pixel_on(uint8_t c, uint32_t x, uint32_t y) const {
+		uint32_t offset = (m_char_y[c] + y) * m_header.m_bitmap_width + m_char_x[c] + x;
+		return m_pixels[offset * (m_header.m_bpp / 8)] != 0;
+	}
+
 };
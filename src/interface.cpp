@@ -51,6 +51,9 @@ SOFTWARE.
 #include "debugger.h"
 #include "keyboard.h"
 #include "speaker.h"
+#include "machine.h"
+#include "rewind.h"
+#include "snapshot.h"
 
 static bool Show_main_menu = true;
 static bool Show_demo_window = false;
@@ -59,6 +62,12 @@ static bool Menu_open_at_start = false;
 
 static int Sound_volume = 50;
 
+// seconds of rewind history to keep.  0 turns rewinding off
+static int Rewind_seconds = 60;
+
+const static float Min_emulator_speed = 0.1f;
+const static float Max_emulator_speed = 10.0f;
+
 static const char *Settings_filename = "settings.txt";
 
 static SDL_Window *Video_window = nullptr;
@@ -120,7 +129,7 @@ static void ui_load_settings()
 			}
 			else if (setting == "emulator_type") {
 				int i_val = strtol(value.c_str(), nullptr, 10);
-				Emulator_type = static_cast<emulator_type>(i_val);
+				Machine->m_type = static_cast<emulator_type>(i_val);
 			}
 			else if (setting == "open_at_start") {
 				int i_val = strtol(value.c_str(), nullptr, 10);
@@ -142,7 +151,22 @@ static void ui_load_settings()
 				video_set_tint(static_cast<video_tint_types>(Video_color_type));
 			}
 			else if (setting == "speed") {
-				Speed_multiplier = (int)strtol(value.c_str(), nullptr, 10);
+				Emulator_speed = (float)strtod(value.c_str(), nullptr);
+				if (Emulator_speed < Min_emulator_speed || Emulator_speed > Max_emulator_speed) {
+					Emulator_speed = 1.0f;
+				}
+			}
+			else if (setting == "disk_turbo") {
+				Disk_turbo = strtol(value.c_str(), nullptr, 10) != 0;
+			}
+			else if (setting == "idle_skip") {
+				Emulator_idle_skip = strtol(value.c_str(), nullptr, 10) != 0;
+			}
+			else if (setting == "disk_turbo_linger") {
+				Disk_turbo_linger_frames = (uint32_t)strtol(value.c_str(), nullptr, 10);
+			}
+			else if (setting == "rewind_seconds") {
+				Rewind_seconds = (int)strtol(value.c_str(), nullptr, 10);
 			}
 			else if (setting == "sound_volume") {
 				int i_val = strtol(value.c_str(), nullptr, 10);
@@ -176,14 +200,18 @@ static void ui_save_settings()
 		return;
 	}
 	fprintf(fp, "auto_start = %d\n", Auto_start == true ? 1 : 0);
-	fprintf(fp, "emulator_type = %d\n", static_cast<uint8_t>(Emulator_type));
+	fprintf(fp, "emulator_type = %d\n", static_cast<uint8_t>(Machine->m_type));
 	fprintf(fp, "open_at_start = %d\n", Menu_open_at_start == true ? 1 : 0);
 	fprintf(fp, "show_drive_indicators = %d\n", Show_drive_indicators == true ? 1 : 0);
 	fprintf(fp, "disk1 = %s\n", disk_get_mounted_filename(1));
 	fprintf(fp, "disk2 = %s\n", disk_get_mounted_filename(2));
 	fprintf(fp, "video = %d\n", Video_color_type);
-	fprintf(fp, "speed = %d\n", Speed_multiplier);
+	fprintf(fp, "speed = %g\n", Emulator_speed);
+	fprintf(fp, "disk_turbo = %d\n", Disk_turbo ? 1 : 0);
+	fprintf(fp, "disk_turbo_linger = %u\n", Disk_turbo_linger_frames);
+	fprintf(fp, "idle_skip = %d\n", Emulator_idle_skip ? 1 : 0);
 	fprintf(fp, "sound_volume = %d\n", Sound_volume);
+	fprintf(fp, "rewind_seconds = %d\n", Rewind_seconds);
 	for (auto &table : Symtables) {
 		fprintf(fp, "Symtable %s = %d\n", table.first.c_str(), table.second?1:0);
 	}
@@ -207,9 +235,12 @@ static void ui_show_general_options()
 		}
 	}
 	ImGui::Checkbox("Open Menu on startup", &Menu_open_at_start);
+	if (ImGui::SliderInt("Rewind Seconds (hold F9)", &Rewind_seconds, 0, 120)) {
+		rewind_init(Rewind_seconds);
+	}
 	ImGui::Separator();
 
-	static int type = static_cast<uint8_t>(Emulator_type);
+	static int type = static_cast<uint8_t>(Machine->m_type);
 	int old_type = type;
 	ImGui::ListBox("Emulation Type", &type, Emulator_names, static_cast<uint8_t>(emulator_type::NUM_EMULATOR_TYPES));
 
@@ -218,7 +249,7 @@ static void ui_show_general_options()
 	// for this change to take effect
 	if (old_type != type && (Emulator_state == emulator_state::SPLASH_SCREEN ||
 		Emulator_state == emulator_state::EMULATOR_TEST)) {
-		Emulator_type = static_cast<emulator_type>(type);
+		Machine->m_type = static_cast<emulator_type>(type);
 		reset_machine();
 	} else if (old_type != type) {
 		// show popup and potentially restart the emulator
@@ -234,14 +265,14 @@ static void ui_show_general_options()
 		if (ImGui::Button("Restart", ImVec2(120, 0))) {
 			// with a restart, set the emulator type,, reset the machine, and for now
 			// go to the splash screen
-			Emulator_type = static_cast<emulator_type>(type);
+			Machine->m_type = static_cast<emulator_type>(type);
 			Emulator_state = emulator_state::SPLASH_SCREEN;
 			reset_machine();
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Cancel", ImVec2(120, 0))) {
-			type = static_cast<uint8_t>(Emulator_type);
+			type = static_cast<uint8_t>(Machine->m_type);
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::EndPopup();
@@ -354,10 +385,46 @@ static void ui_show_sound_menu()
 	}
 }
 
+// save and load the whole machine through the file dialogs
+static void ui_show_state_menu()
+{
+	if (ImGui::MenuItem("Save State...")) {
+		nfdchar_t *outPath = NULL;
+		if (NFD_SaveDialog("a2s", nullptr, &outPath) == NFD_OKAY) {
+			machine_snapshot snapshot;
+			snapshot_capture(snapshot);
+			snapshot_save(snapshot, outPath);
+			free(outPath);
+		}
+	}
+	if (ImGui::MenuItem("Load State...")) {
+		nfdchar_t *outPath = NULL;
+		if (NFD_OpenDialog("a2s", nullptr, &outPath) == NFD_OKAY) {
+			machine_snapshot snapshot;
+			if (snapshot_load(snapshot, outPath) && snapshot_restore(snapshot) == false) {
+				machine_reset();
+			}
+			free(outPath);
+		}
+	}
+}
+
 static void ui_show_speed_menu()
 {
-	if (ImGui::SliderInt("Emulator Speed", (int *)&Speed_multiplier, 1, 100) == true) {
+	ImGui::SliderFloat("Emulator Speed", &Emulator_speed, Min_emulator_speed, Max_emulator_speed, "%.2fx", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+	if (ImGui::Button("Normal Speed")) {
+		Emulator_speed = 1.0f;
 	}
+	ImGui::Checkbox("Warp (F8)", &Emulator_warp);
+	ImGui::Separator();
+	ImGui::Checkbox("Disk Turbo", &Disk_turbo);
+	int linger = (int)Disk_turbo_linger_frames;
+	if (ImGui::SliderInt("Frames After Motor Off", &linger, 0, 120)) {
+		Disk_turbo_linger_frames = (uint32_t)linger;
+	}
+	ImGui::Text("Time saved: %.1f seconds", apple2emu_get_disk_turbo_seconds_saved());
+	ImGui::Separator();
+	ImGui::Checkbox("Skip Idle Keyboard Loops", &Emulator_idle_skip);
 }
 
 static void ui_show_edit_menu()
@@ -373,6 +440,7 @@ static void ui_show_main_menu()
 	if (ImGui::BeginMainMenuBar()) {
 		if (ImGui::BeginMenu("File")) {
 			ui_show_general_options();
+			ui_show_state_menu();
 			ui_show_speed_menu();
 			ImGui::EndMenu();
 		}
@@ -439,6 +507,7 @@ void ui_init()
 		ui_load_settings();
 		settings_loaded = true;
 	}
+	rewind_init(Rewind_seconds);
 
 	Video_native_size.x = 0;
 	Video_native_size.y = 0;
@@ -607,12 +676,6 @@ void ui_do_frame()
 	glClearColor(0.5f, 0.5f, 0.5f, 0);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	// render to the framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, Video_framebuffer);
-	glViewport(0, 0, Video_native_width, Video_native_height);
-	glClearColor(0.5f, 0, 0, 0);
-	glClear(GL_COLOR_BUFFER_BIT);
-
 	glDisable(GL_DEPTH_TEST);
 	glDepthMask(false);
 
@@ -626,6 +689,14 @@ void ui_do_frame()
 
 	GLfloat *tint_colors;
 	if (Emulator_state == emulator_state::SPLASH_SCREEN) {
+		// render the splash screen to the framebuffer.  This overwrites
+		// the emulator screen so it will need to be fully redrawn
+		glBindFramebuffer(GL_FRAMEBUFFER, Video_framebuffer);
+		glViewport(0, 0, Video_native_width, Video_native_height);
+		glClearColor(0.5f, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+		video_invalidate();
+
 		// blit splash screen
 		glBindTexture(GL_TEXTURE_2D, Splash_screen_texture);
 		glColor3f(1.0f, 1.0f, 1.0f);
@@ -638,8 +709,14 @@ void ui_do_frame()
 		glBindTexture(GL_TEXTURE_2D, 0);
 		tint_colors = video_get_tint(video_tint_types::MONO_WHITE);
 	} else {
-		extern void video_render();
-		video_render();
+		// decode the screen on the cpu and upload it with a single
+		// texture update.  The upload is skipped when nothing on
+		// the screen changed
+		if (video_render()) {
+			glBindTexture(GL_TEXTURE_2D, Video_framebuffer_texture);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Video_native_width, Video_native_height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, video_get_framebuffer());
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
 		tint_colors = video_get_tint();
 	}
 	ImVec4 tint(tint_colors[0], tint_colors[1], tint_colors[2], 0xff);
@@ -734,6 +811,22 @@ void ui_do_frame()
 	}
 
 
+	// run as fast as possible until F8 is pressed again
+	if (dbg_active == false && ImGui::IsKeyPressed(SDL_SCANCODE_F8, false)) {
+		io.WantCaptureKeyboard = true;
+		Emulator_warp = !Emulator_warp;
+	}
+
+	// run backwards through the rewind history while F9 is held down
+	if (dbg_active == false && ImGui::IsKeyDown(SDL_SCANCODE_F9)) {
+		io.WantCaptureKeyboard = true;
+		if (Emulator_state == emulator_state::EMULATOR_STARTED) {
+			Emulator_state = emulator_state::EMULATOR_REWINDING;
+		}
+	} else if (Emulator_state == emulator_state::EMULATOR_REWINDING) {
+		Emulator_state = emulator_state::EMULATOR_STARTED;
+	}
+
 	if (ImGui::IsKeyPressed(SDL_SCANCODE_PAUSE, false)) {
 		io.WantCaptureKeyboard = true;
 		if (Emulator_state == emulator_state::EMULATOR_STARTED) {
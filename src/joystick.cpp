@@ -32,7 +32,10 @@ SOFTWARE.
 #include "apple2emu_defs.h"
 #include "apple2emu.h"
 #include "memory.h"
+#include "scheduler.h"
 #include "joystick.h"
+#include "machine.h"
+#include "snapshot.h"
 
 static int Num_controllers;
 static const char *Game_controller_mapping_file = "gamecontrollerdb.txt";
@@ -45,7 +48,6 @@ public:
 	const char              *m_name;          // name of controller
 	int8_t                   m_button_state[SDL_CONTROLLER_BUTTON_MAX];
 	int16_t                  m_axis_state[SDL_CONTROLLER_AXIS_MAX];
-	uint32_t                 m_axis_timer_state[SDL_CONTROLLER_AXIS_MAX];
 	SDL_GameControllerButton m_buttons[SDL_CONTROLLER_BUTTON_MAX];  // mapping from button number to button enum
 	SDL_GameControllerAxis   m_axis[SDL_CONTROLLER_AXIS_MAX];       // mapping from axis number to axis enum
 
@@ -57,6 +59,8 @@ const float Joystick_cycles_scale = 2816.0f / 255.0f;   // ~2816 total cycles fo
 const int Max_controllers = 16;
 controller Controllers[Max_controllers];
 
+THREAD_LOCAL joystick_state *Joystick = nullptr;
+
 // reads the status of button num from the joystick structures
 static uint8_t joystick_read_button(int button_num)
 {
@@ -67,19 +71,54 @@ static uint8_t joystick_read_button(int button_num)
 
 static uint8_t joystick_read_axis(int axis_num)
 {
-	// timer state for paddles is controlled by ths number of cycles.  The axis
-	// timer state will have been previously set to the total cycles run
-	// plus the axis value * number of cycles
-	if (Total_cycles < Controllers[0].m_axis_timer_state[axis_num]) {
+	// timer state for paddles is set when the timers are triggered and
+	// cleared by a scheduled event after the axis value * number of cycles
+	if (Joystick->m_axis_timer_state[axis_num]) {
 		return 0x80;
 	}
 	return 0;
 }
 
-uint8_t joystick_soft_switch_handler(uint16_t addr, uint8_t val, bool write)
+// scheduler callback when the 558 timer for an axis times out
+static void joystick_axis_timeout(void *context, uint64_t cycle)
 {
-	UNREFERENCED(write);
-	UNREFERENCED(val);
+	UNREFERENCED(cycle);
+	bool *timer_state = static_cast<bool *>(context);
+	*timer_state = false;
+}
+
+// this function initiates the analog to digital conversion from the
+// controllers (paddles/joysticks) to 0-255 digital value which will
+// be read from the axis read handler.  Basically set up
+// internal timer to indicate when the 558 timer should time out
+// based on the paddle/joystick value.  Read Inside the Apple ][e
+// chapter 10 for more information
+static void joystick_trigger_timers()
+{
+	// set the axis timer state to be current cycle count
+	// plus the cycle count when the timer should time out.
+	// The internal paddle read routine reads every 11ms
+	for (auto i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+		int16_t value = SDL_GameControllerGetAxis(Controllers[0].m_gc, Controllers[0].m_axis[i]);
+		value = (uint16_t)(floor((float)(value + 32768) * (float)(255.0f / 65535.0f)));
+		// from kegs and other emulators.  I need to dig into why this is necessary because
+		// based on timings, it should not work like this.  Currently, I am getting a value
+		// back from the pdl read code of around 235 when axis at max value (instead of
+		// 255).  So this code (as is in other emulators) will force us to get to 255.  But
+		// seems like we should solve this the real way with timing.
+		if (value >= 255) {
+			value = 280;
+		}
+		bool *timer_state = &Joystick->m_axis_timer_state[i];
+		scheduler_remove_event(joystick_axis_timeout, timer_state);
+		scheduler_add_event(Machine->m_total_cycles + uint64_t(value * Joystick_cycles_scale), joystick_axis_timeout, timer_state);
+		*timer_state = true;
+	}
+}
+
+uint8_t joystick_soft_switch_read(void *context, uint16_t addr)
+{
+	UNREFERENCED(context);
 	uint8_t return_val = 0;
 
 	addr = addr & 0xff;
@@ -95,40 +134,36 @@ uint8_t joystick_soft_switch_handler(uint16_t addr, uint8_t val, bool write)
 	case 0x67:
 		return_val = joystick_read_axis(addr - 0x64);
 		break;
-
-	// this function initiates the analog to digital conversion from the
-	// controllers (paddles/joysticks) to 0-255 digital value which will
-	// be read from the axis read handler.  Basically set up
-	// internal timer to indicate when the 558 timer should time out
-	// based on the paddle/joystick value.  Read Inside the Apple ][e
-	// chapter 10 for more information
 	case 0x70:
-		// set the axis timer state to be current cycle count
-		// plus the cycle count when the timer should time out.
-		// The internal paddle read routine reads every 11ms
-		for (auto i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
-			int16_t value = SDL_GameControllerGetAxis(Controllers[0].m_gc, Controllers[0].m_axis[i]);
-			value = (uint16_t)(floor((float)(value + 32768) * (float)(255.0f / 65535.0f)));
-			// from kegs and other emulators.  I need to dig into why this is necessary because
-			// based on timings, it should not work like this.  Currently, I am getting a value
-			// back from the pdl read code of around 235 when axis at max value (instead of
-			// 255).  So this code (as is in other emulators) will force us to get to 255.  But
-			// seems like we should solve this the real way with timing.
-			if (value >= 255) {
-				value = 280;
-			}
-			Controllers[0].m_axis_timer_state[i] = Total_cycles + uint32_t(value * Joystick_cycles_scale);
-		}
+		joystick_trigger_timers();
+		break;
 	}
 
-	if (write) {
-		return 0;
-	}
 	return return_val | memory_read_floating_bus();
 }
 
+void joystick_soft_switch_write(void *context, uint16_t addr, uint8_t val)
+{
+	UNREFERENCED(context);
+	UNREFERENCED(val);
+
+	if ((addr & 0xff) == 0x70) {
+		joystick_trigger_timers();
+	}
+}
+
 void joystick_init()
 {
+	// any pending timer events were cleared on reset
+	for (auto i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+		Joystick->m_axis_timer_state[i] = false;
+	}
+
+	// no controllers when running headless
+	if (SDL_WasInit(SDL_INIT_GAMECONTROLLER) == 0) {
+		return;
+	}
+
 	// load game controller mappings
 	int num_mappings = SDL_GameControllerAddMappingsFromFile(Game_controller_mapping_file);
 	if (num_mappings == -1) {
@@ -150,7 +185,6 @@ void joystick_init()
 				}
 				for (auto j = 0; j < SDL_CONTROLLER_AXIS_MAX; j++) {
 					Controllers[i].m_axis_state[j] = 0;
-					Controllers[i].m_axis_timer_state[j] = 0;
 					Controllers[i].m_axis[j] = static_cast<SDL_GameControllerAxis>(static_cast<int>(SDL_CONTROLLER_AXIS_LEFTX) + j);
 				}
 			}
@@ -166,3 +200,28 @@ void joystick_shutdown()
 		}
 	}
 }
+
+// the paddle timers along with when the running ones time out
+void joystick_save_state(snapshot_writer &writer)
+{
+	for (auto i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+		uint64_t timeout_cycle = 0;
+		scheduler_find_event(joystick_axis_timeout, &Joystick->m_axis_timer_state[i], timeout_cycle);
+		writer.write(Joystick->m_axis_timer_state[i]);
+		writer.write(timeout_cycle);
+	}
+}
+
+void joystick_load_state(snapshot_reader &reader)
+{
+	for (auto i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+		uint64_t timeout_cycle;
+		bool *timer_state = &Joystick->m_axis_timer_state[i];
+		reader.read(*timer_state);
+		reader.read(timeout_cycle);
+		scheduler_remove_event(joystick_axis_timeout, timer_state);
+		if (*timer_state) {
+			scheduler_add_event(timeout_cycle, joystick_axis_timeout, timer_state);
+		}
+	}
+}
@@ -27,6 +27,24 @@ SOFTWARE.
 
 #pragma once
 
+#include "SDL.h"
+#include "apple2emu_defs.h"
+
+class snapshot_writer;
+class snapshot_reader;
+
+// paddle timers of one machine (see machine.h).  The controllers
+// themselves belong to the host so they are shared
+struct joystick_state {
+	bool m_axis_timer_state[SDL_CONTROLLER_AXIS_MAX];   // true while the 558 timer is running
+};
+
+// paddle timers of the machine running on this thread
+extern THREAD_LOCAL joystick_state *Joystick;
+
 void joystick_init();
 void joystick_shutdown();
-uint8_t joystick_soft_switch_handler(uint16_t addr, uint8_t val, bool write);
+uint8_t joystick_soft_switch_read(void *context, uint16_t addr);
+void joystick_soft_switch_write(void *context, uint16_t addr, uint8_t val);
+void joystick_save_state(snapshot_writer &writer);
+void joystick_load_state(snapshot_reader &reader);
@@ -25,6 +25,8 @@ SOFTWARE.
 
 */
 
+#include <algorithm>
+
 #include "SDL.h"
 
 #include "libclipboard.h"
@@ -32,33 +34,44 @@ SOFTWARE.
 #include "apple2emu_defs.h"
 #include "apple2emu.h"
 #include "keyboard.h"
+#include "machine.h"
+#include "memory.h"
 #include "video.h"
 #include "debugger.h"
 #include "interface.h"
+#include "snapshot.h"
 
 #define KEY_SHIFT   (1<<8)
 #define KEY_CTRL    (1<<9)
 
-static bool Keyboard_caps_lock_on = true;
+THREAD_LOCAL keyboard_state *Keyboard = nullptr;
 
-static const int Keybuffer_size = 32;
+// the host clipboard.  Only opened the first time something is pasted
+static clipboard_c* Clipboard;
 
-static int key_buffer_front, key_buffer_end;
-static int key_buffer[Keybuffer_size];
+// idle skipping.  Only the interactive emulator turns this on
+static bool Idle_skip = false;
 
-static clipboard_c* Clipboard;
-static const char *Clipboard_ptr;
+// the input loops in the roms count their polls in RNDL/RNDH so that
+// programs can seed a random number generator off of how long it took
+// for someone to press a key
+const static uint16_t Idle_counter_addr = 0x4e;
+
+// a loop has to poll this many times in a row, the same way each time,
+// before it is taken as idle.  The loop has to be tight as well
+const static uint32_t Idle_poll_threshold = 8;
+const static uint32_t Idle_max_poll_period = 256;
 
 // inserts a key into the keyboard buffer
 static void keyboard_insert_key(uint32_t code)
 {
 	// Buffer full, ignore keystroke
-	if ((key_buffer_end + 1) % Keybuffer_size == key_buffer_front) {
+	if ((Keyboard->m_buffer_end + 1) % Keybuffer_size == Keyboard->m_buffer_front) {
 		return;
 	}
 
-	key_buffer[key_buffer_end] = code;
-	key_buffer_end = (key_buffer_end + 1) % Keybuffer_size;
+	Keyboard->m_buffer[Keyboard->m_buffer_end] = code;
+	Keyboard->m_buffer_end = (Keyboard->m_buffer_end + 1) % Keybuffer_size;
 }
 
 static uint8_t keyboard_get_key()
@@ -66,17 +79,17 @@ static uint8_t keyboard_get_key()
 	uint32_t key;
 
 	// Buffer empty
-	if (key_buffer_front == key_buffer_end) {
+	if (Keyboard->m_buffer_front == Keyboard->m_buffer_end) {
 		return 0;
 	}
 
-	key = key_buffer[key_buffer_front];
-    key_buffer[key_buffer_front] = 0;
+	key = Keyboard->m_buffer[Keyboard->m_buffer_front];
+    Keyboard->m_buffer[Keyboard->m_buffer_front] = 0;
 
 	do {
-		key_buffer_front = (key_buffer_front + 1) % Keybuffer_size;
+		Keyboard->m_buffer_front = (Keyboard->m_buffer_front + 1) % Keybuffer_size;
 		// Advance past invalidated entries
-	} while (key_buffer[key_buffer_front] == 0 && key_buffer_front != key_buffer_end);
+	} while (Keyboard->m_buffer[Keyboard->m_buffer_front] == 0 && Keyboard->m_buffer_front != Keyboard->m_buffer_end);
 
 	SDL_assert(key <= UINT8_MAX);
 
@@ -85,19 +98,26 @@ static uint8_t keyboard_get_key()
 
 void keyboard_init()
 {
-	key_buffer_front = 0;
-	key_buffer_end = 0;
+	Keyboard->m_buffer_front = 0;
+	Keyboard->m_buffer_end = 0;
 	for (auto i = 0; i < Keybuffer_size; i++) {
-		key_buffer[i] = 0;
+		Keyboard->m_buffer[i] = 0;
 	}
-	if (Emulator_type >= emulator_type::APPLE2E) {
-		Keyboard_caps_lock_on = true;
+	if (Machine->m_type >= emulator_type::APPLE2E) {
+		Keyboard->m_caps_lock_on = true;
 	} else {
-		Keyboard_caps_lock_on = false;
+		Keyboard->m_caps_lock_on = false;
 	}
-
-    Clipboard = clipboard_new(nullptr);
-    Clipboard_ptr = nullptr;
+    Keyboard->m_clipboard_ptr = nullptr;
+	Keyboard->m_poll_cycle = 0;
+	Keyboard->m_poll_period = 0;
+	Keyboard->m_poll_pc = 0;
+	Keyboard->m_poll_counter = 0;
+	Keyboard->m_poll_access_count = 0;
+	Keyboard->m_poll_acc = Keyboard->m_poll_x = Keyboard->m_poll_y = 0;
+	Keyboard->m_poll_sp = Keyboard->m_poll_status = 0;
+	Keyboard->m_poll_counter_step = Keyboard->m_poll_x_step = Keyboard->m_poll_y_step = 0;
+	Keyboard->m_idle_polls = 0;
 }
 
 void keyboard_shutdown()
@@ -128,7 +148,7 @@ void keyboard_handle_event(uint32_t key, bool shift, bool ctrl, bool alt, bool s
 	// if the caps lock key was down, change toggle internal
 	// caps lock setting (for non apple2 machines)
 	if (key == SDLK_CAPSLOCK) {
-		Keyboard_caps_lock_on = !Keyboard_caps_lock_on;
+		Keyboard->m_caps_lock_on = !Keyboard->m_caps_lock_on;
 	}
 
 	// figure out the actual keyvalue to put onto the keyboard
@@ -157,7 +177,7 @@ void keyboard_handle_event(uint32_t key, bool shift, bool ctrl, bool alt, bool s
 			key = 0;
 		}
 	} else if (key >= SDLK_a && key <= SDLK_z) {
-		if (Emulator_type < emulator_type::APPLE2E || Keyboard_caps_lock_on) {
+		if (Machine->m_type < emulator_type::APPLE2E || Keyboard->m_caps_lock_on) {
 			key -= 32;
 		}
 	}
@@ -171,54 +191,218 @@ void keyboard_handle_event(uint32_t key, bool shift, bool ctrl, bool alt, bool s
 	keyboard_insert_key(key);
 }
 
-static uint8_t last_key = 0;
+static uint16_t keyboard_read_idle_counter()
+{
+	return memory_read(Idle_counter_addr) | (memory_read(Idle_counter_addr + 1) << 8);
+}
+
+// look for the machine sitting in a loop waiting for a key.  Every empty
+// poll is compared against the one before: same place in the code, same
+// number of cycles since the last one, the same registers and the same
+// change to RNDL/RNDH.  A loop may count RNDL/RNDH up and X or Y down
+// (the IIe does both) but nothing else.  In between polls it may not
+// write memory or touch a soft switch, other than the poll itself and
+// the write that counts RNDL up.  Once enough polls match, the cpu
+// is stopped after each one so that the loop can be skipped over (see
+// keyboard_skip_idle_polls())
+static void keyboard_note_poll(uint8_t key)
+{
+	if ((key & 0x80) != 0 || Keyboard->m_clipboard_ptr != nullptr) {
+		Keyboard->m_idle_polls = 0;
+		return;
+	}
+
+	cpu_6502 &cpu = Machine->m_cpu;
+	uint64_t cycle = Machine->m_total_cycles;
+	uint16_t counter = keyboard_read_idle_counter();
+	uint64_t period = cycle - Keyboard->m_poll_cycle;
+	int8_t counter_step = int8_t(counter - Keyboard->m_poll_counter);
+	int8_t x_step = int8_t(cpu.get_x() - Keyboard->m_poll_x);
+	int8_t y_step = int8_t(cpu.get_y() - Keyboard->m_poll_y);
+	uint32_t accesses = Memory->m_access_count - Keyboard->m_poll_access_count;
+
+	if (cycle > Keyboard->m_poll_cycle && period <= Idle_max_poll_period &&
+		period == Keyboard->m_poll_period && cpu.get_pc() == Keyboard->m_poll_pc &&
+		cpu.get_acc() == Keyboard->m_poll_acc && cpu.get_sp() == Keyboard->m_poll_sp &&
+		cpu.get_status() == Keyboard->m_poll_status &&
+		counter_step == Keyboard->m_poll_counter_step && (counter_step == 0 || counter_step == 1) &&
+		accesses == uint32_t(1 + counter_step) &&
+		x_step == Keyboard->m_poll_x_step && (x_step == 0 || x_step == -1) &&
+		y_step == Keyboard->m_poll_y_step && (y_step == 0 || y_step == -1)) {
+		Keyboard->m_idle_polls++;
+	} else {
+		Keyboard->m_idle_polls = 0;
+	}
+	Keyboard->m_poll_cycle = cycle;
+	Keyboard->m_poll_period = uint32_t(std::min<uint64_t>(period, UINT32_MAX));
+	Keyboard->m_poll_pc = cpu.get_pc();
+	Keyboard->m_poll_counter = counter;
+	Keyboard->m_poll_access_count = Memory->m_access_count;
+	Keyboard->m_poll_acc = cpu.get_acc();
+	Keyboard->m_poll_x = cpu.get_x();
+	Keyboard->m_poll_y = cpu.get_y();
+	Keyboard->m_poll_sp = cpu.get_sp();
+	Keyboard->m_poll_status = cpu.get_status();
+	Keyboard->m_poll_counter_step = counter_step;
+	Keyboard->m_poll_x_step = x_step;
+	Keyboard->m_poll_y_step = y_step;
+
+	if (Idle_skip && Keyboard->m_idle_polls >= Idle_poll_threshold) {
+		Machine->m_cpu.request_exit();
+	}
+}
+
+void keyboard_set_idle_skip(bool on)
+{
+	if (Idle_skip != on) {
+		Idle_skip = on;
+		Keyboard->m_idle_polls = 0;
+	}
+}
+
+// number of polls that a count can be moved on by before the loop
+// would do something different with it.  Counting up, that is RNDL
+// wrapping around (the IIe blinks the cursor then), and counting down
+// it is reaching zero
+static uint64_t keyboard_polls_before_wrap(uint8_t value, int8_t step)
+{
+	if (step > 0) {
+		return uint8_t(0xff - value);
+	} else if (step < 0) {
+		return uint8_t(value - 1);
+	}
+	return UINT64_MAX;
+}
+
+// skip over whole passes of an idle input loop, up to max_cycles worth.
+// The cpu has just come out of a poll, so jumping ahead a whole number
+// of loop periods leaves it in the same place with the counts moved on
+// by the skipped polls.  The skip stops short of any count wrapping so
+// that the loop gets to run whatever it does then.  Returns the number
+// of cycles skipped, which the caller adds to the machine's cycle counts
+uint32_t keyboard_skip_idle_polls(uint64_t max_cycles)
+{
+	if (Idle_skip == false || Keyboard->m_idle_polls < Idle_poll_threshold ||
+		Machine->m_total_cycles - Keyboard->m_poll_cycle >= Keyboard->m_poll_period) {
+		return 0;
+	}
+
+	// the cpu has to be between this poll and the next for the loop to
+	// line up again, so nothing may have moved on since the poll
+	cpu_6502 &cpu = Machine->m_cpu;
+	uint16_t counter = keyboard_read_idle_counter();
+	if (counter != Keyboard->m_poll_counter || cpu.get_x() != Keyboard->m_poll_x || cpu.get_y() != Keyboard->m_poll_y ||
+		Memory->m_access_count != Keyboard->m_poll_access_count) {
+		return 0;
+	}
+
+	uint64_t polls = max_cycles / Keyboard->m_poll_period;
+	polls = std::min(polls, keyboard_polls_before_wrap(counter & 0xff, Keyboard->m_poll_counter_step));
+	polls = std::min(polls, keyboard_polls_before_wrap(cpu.get_x(), Keyboard->m_poll_x_step));
+	polls = std::min(polls, keyboard_polls_before_wrap(cpu.get_y(), Keyboard->m_poll_y_step));
+	if (polls == 0) {
+		return 0;
+	}
+
+	counter = uint16_t(counter + polls * Keyboard->m_poll_counter_step);
+	memory_write(Idle_counter_addr, counter & 0xff);
+	memory_write(Idle_counter_addr + 1, counter >> 8);
+	cpu.set_x(uint8_t(cpu.get_x() + polls * Keyboard->m_poll_x_step));
+	cpu.set_y(uint8_t(cpu.get_y() + polls * Keyboard->m_poll_y_step));
+
+	uint32_t cycles = uint32_t(polls * Keyboard->m_poll_period);
+	Keyboard->m_poll_cycle += cycles;
+	Keyboard->m_poll_counter = counter;
+	Keyboard->m_poll_access_count = Memory->m_access_count;   // the counter writes above don't count
+	Keyboard->m_poll_x = cpu.get_x();
+	Keyboard->m_poll_y = cpu.get_y();
+	return cycles;
+}
 
 uint8_t keyboard_read()
 {
-    if (Clipboard_ptr != nullptr) {
-        uint8_t key = *Clipboard_ptr;
+    if (Keyboard->m_clipboard_ptr != nullptr) {
+        uint8_t key = *Keyboard->m_clipboard_ptr;
         if (key == '\0') {
             key = 0;
-            Clipboard_ptr = nullptr;
+            Keyboard->m_clipboard_ptr = nullptr;
         } else {
             if (key == '\n') {
                 key = '\r';
             }
-            last_key = 0x80 | key;
+            Keyboard->m_last_key = 0x80 | key;
         }
     } else {
         uint8_t temp_key = keyboard_get_key();
         if (temp_key > 0) {
-            last_key = temp_key | 0x80;
+            Keyboard->m_last_key = temp_key | 0x80;
         }
     }
 
-	return last_key;
+	keyboard_note_poll(Keyboard->m_last_key);
+	return Keyboard->m_last_key;
 }
 
 uint8_t keyboard_clear()
 {
-    if (Clipboard_ptr != nullptr) {
-        uint8_t key = *Clipboard_ptr;
-        Clipboard_ptr++;
+    if (Keyboard->m_clipboard_ptr != nullptr) {
+        uint8_t key = *Keyboard->m_clipboard_ptr;
+        Keyboard->m_clipboard_ptr++;
         if (key == '\n') {
             key = '\r';
         }
         else if (key == '\0') {
             key = 0;
-            Clipboard_ptr = nullptr;
+            Keyboard->m_clipboard_ptr = nullptr;
         }
-        last_key = key;
+        Keyboard->m_last_key = key;
     } else {
-        last_key &= 0x7F;
+        Keyboard->m_last_key &= 0x7F;
     }
 
-	return last_key;
+	return Keyboard->m_last_key;
 }
 
 // get the clipboard and set the keyboard code to
 // process the clipboard instead of keys
 void keyboard_paste_clipboard()
 {
-    Clipboard_ptr = clipboard_text(Clipboard);
+    if (Clipboard == nullptr) {
+        Clipboard = clipboard_new(nullptr);
+    }
+    Keyboard->m_clipboard_ptr = clipboard_text(Clipboard);
+}
+
+// type in the given text the same way as pasting from the clipboard.
+// The text needs to stay around until it has all been read
+void keyboard_paste_text(const char *text)
+{
+    Keyboard->m_clipboard_ptr = text;
+}
+
+// keys typed but not read yet.  Text being pasted is left out, it
+// belongs to the host and may not be around any more
+void keyboard_save_state(snapshot_writer &writer)
+{
+	writer.write(Keyboard->m_buffer);
+	writer.write(Keyboard->m_buffer_front);
+	writer.write(Keyboard->m_buffer_end);
+	writer.write(Keyboard->m_caps_lock_on);
+	writer.write(Keyboard->m_last_key);
+}
+
+void keyboard_load_state(snapshot_reader &reader)
+{
+	reader.read(Keyboard->m_buffer);
+	reader.read(Keyboard->m_buffer_front);
+	reader.read(Keyboard->m_buffer_end);
+	reader.read(Keyboard->m_caps_lock_on);
+	reader.read(Keyboard->m_last_key);
+	if (Keyboard->m_buffer_front < 0 || Keyboard->m_buffer_front >= Keybuffer_size ||
+		Keyboard->m_buffer_end < 0 || Keyboard->m_buffer_end >= Keybuffer_size) {
+		reader.set_error();
+		Keyboard->m_buffer_front = Keyboard->m_buffer_end = 0;
+	}
+	Keyboard->m_clipboard_ptr = nullptr;
+	Keyboard->m_idle_polls = 0;
 }
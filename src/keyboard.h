@@ -29,6 +29,36 @@ SOFTWARE.
 
 #pragma once
 
+#include <stdint.h>
+#include "apple2emu_defs.h"
+
+class snapshot_writer;
+class snapshot_reader;
+
+static const int Keybuffer_size = 32;
+
+// keyboard state of one machine (see machine.h)
+struct keyboard_state {
+	int         m_buffer[Keybuffer_size];
+	int         m_buffer_front, m_buffer_end;
+	bool        m_caps_lock_on;
+	const char *m_clipboard_ptr;   // text being typed in from a paste
+	uint8_t     m_last_key;
+
+	// idle detection.  Filled in on every read of the keyboard that
+	// finds no key waiting (see keyboard_skip_idle_polls())
+	uint64_t    m_poll_cycle;      // cycle count of the last empty poll
+	uint32_t    m_poll_period;     // cycles between the last two empty polls
+	uint16_t    m_poll_pc;
+	uint16_t    m_poll_counter;    // RNDL/RNDH at the last empty poll
+	uint32_t    m_poll_access_count;   // memory access count (see memory.h) at the last empty poll
+	uint8_t     m_poll_acc, m_poll_x, m_poll_y, m_poll_sp, m_poll_status;
+	int8_t      m_poll_counter_step, m_poll_x_step, m_poll_y_step;   // change between the last two
+	uint32_t    m_idle_polls;      // empty polls in a row that matched the one before
+};
+
+// keyboard of the machine running on this thread
+extern THREAD_LOCAL keyboard_state *Keyboard;
 
 void keyboard_init();
 void keyboard_shutdown();
@@ -36,3 +66,8 @@ void keyboard_handle_event(uint32_t key, bool shift, bool ctrl, bool alt, bool s
 uint8_t keyboard_read();
 uint8_t keyboard_clear();
 void keyboard_paste_clipboard();
+void keyboard_paste_text(const char *text);
+void keyboard_set_idle_skip(bool on);
+uint32_t keyboard_skip_idle_polls(uint64_t max_cycles);
+void keyboard_save_state(snapshot_writer &writer);
+void keyboard_load_state(snapshot_reader &reader);
@@ -0,0 +1,180 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <algorithm>
+#include <string.h>
+
+#include "machine.h"
+
+THREAD_LOCAL apple2_machine *Machine = nullptr;
+
+uint32_t Frames_per_second = 60;
+
+// short names for the machine types (--machine option and batch
+// manifests), in emulator_type order
+static const char *Machine_type_names[static_cast<uint8_t>(emulator_type::NUM_EMULATOR_TYPES)] = {
+	"2",
+	"2+",
+	"2e",
+	"2ee",
+};
+
+// allocates a new machine of the given type.  The machine starts out
+// zeroed the same as the old globals did, and still needs to be made
+// current and reset before it can run
+apple2_machine *machine_create(emulator_type type)
+{
+	apple2_machine *machine = new apple2_machine();
+	machine->m_type = type;
+	machine->m_video.m_mode = VIDEO_MODE_TEXT;
+	return machine;
+}
+
+// releases the disk images, audio device and memory owned by the machine
+void machine_destroy(apple2_machine *machine)
+{
+	if (machine == nullptr) {
+		return;
+	}
+
+	apple2_machine *previous = Machine;
+	machine_set_current(machine);
+	disk_shutdown();
+	speaker_shutdown();
+	memory_shutdown();
+	machine_set_current(previous != machine ? previous : nullptr);
+
+	delete machine;
+}
+
+// points this thread's module state at the given machine
+void machine_set_current(apple2_machine *machine)
+{
+	Machine = machine;
+	Memory = machine != nullptr ? &machine->m_memory : nullptr;
+	Video = machine != nullptr ? &machine->m_video : nullptr;
+	Disk = machine != nullptr ? &machine->m_disk : nullptr;
+	Keyboard = machine != nullptr ? &machine->m_keyboard : nullptr;
+	Speaker = machine != nullptr ? &machine->m_speaker : nullptr;
+	Scheduler = machine != nullptr ? &machine->m_scheduler : nullptr;
+	Joystick = machine != nullptr ? &machine->m_joystick : nullptr;
+	Z80softcard = machine != nullptr ? &machine->m_z80softcard : nullptr;
+}
+
+// looks up a machine type from its short name (2, 2+, 2e or 2ee)
+bool machine_type_from_name(const char *name, emulator_type &type)
+{
+	for (uint8_t i = 0; i < static_cast<uint8_t>(emulator_type::NUM_EMULATOR_TYPES); i++) {
+		if (strcmp(Machine_type_names[i], name) == 0) {
+			type = static_cast<emulator_type>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+// power cycles the current machine for its machine type.  Mounted
+// disks stay in the drives
+void machine_reset()
+{
+	cpu_6502::cpu_mode mode;
+	if (Machine->m_type == emulator_type::APPLE2E_ENHANCED) {
+		mode = cpu_6502::cpu_mode::CPU_65C02;
+	} else {
+		mode = cpu_6502::cpu_mode::CPU_6502;
+	}
+
+	// clear out pending events before the peripherals register theirs
+	scheduler_init();
+	memory_init();
+	Machine->m_cpu.init(mode);
+	z80softcard_init();
+	speaker_init();
+	keyboard_init();
+	joystick_init();
+	disk_init();
+	video_init();
+
+	z80softcard_reset(&Machine->m_z80_cpu);
+}
+
+// run the current machine as fast as possible until one of the budgets
+// or exit conditions in options is reached.  Nothing is drawn and the
+// frame rate isn't capped
+machine_run_result machine_run(const machine_run_options &options)
+{
+	// stop on the exit pc through the cpu break map so that it is exact
+	uint8_t exit_map[0x10000 / 8];
+	const uint8_t *break_map = nullptr;
+	if (options.m_exit_pc != -1) {
+		memset(exit_map, 0, sizeof(exit_map));
+		exit_map[options.m_exit_pc >> 3] |= 1 << (options.m_exit_pc & 7);
+		break_map = exit_map;
+	}
+
+	machine_run_result result = {};
+	uint64_t start_cycles = Machine->m_total_cycles;
+
+	while (result.m_exit_reason == nullptr) {
+		uint32_t cycles = z80softcard_emulate(&Machine->m_z80_cpu, 0);
+		if (cycles == 0) {
+			uint64_t budget = Cycles_per_frame - Machine->m_total_cycles_this_frame + 1;
+			if (options.m_max_cycles != 0) {
+				budget = std::min(budget, options.m_max_cycles - (Machine->m_total_cycles - start_cycles));
+			}
+			Machine->m_cpu.run(static_cast<uint32_t>(budget), break_map);
+		} else {
+			Machine->m_total_cycles_this_frame += cycles;
+			Machine->m_total_cycles += cycles;
+		}
+		scheduler_process(Machine->m_total_cycles);
+		speaker_update();
+
+		if (options.m_exit_pc != -1 && Machine->m_cpu.get_pc() == options.m_exit_pc) {
+			result.m_exit_reason = "exit_pc";
+		}
+		if (Machine->m_total_cycles_this_frame > Cycles_per_frame) {
+			Machine->m_total_cycles_this_frame -= Cycles_per_frame;
+			memory_end_frame();
+			result.m_frames++;
+
+			if (options.m_exit_text != nullptr && video_get_screen_text().find(options.m_exit_text) != std::string::npos) {
+				result.m_exit_reason = "exit_text";
+			}
+			else if (options.m_max_frames != 0 && result.m_frames >= options.m_max_frames) {
+				result.m_exit_reason = "frames";
+			}
+		}
+		if (result.m_exit_reason == nullptr && options.m_max_cycles != 0 && Machine->m_total_cycles - start_cycles >= options.m_max_cycles) {
+			result.m_exit_reason = "cycles";
+		}
+	}
+
+	result.m_cycles = Machine->m_total_cycles - start_cycles;
+	return result;
+}
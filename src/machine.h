@@ -0,0 +1,95 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include "apple2emu_defs.h"
+#include "apple2emu.h"
+#include "6502.h"
+#include "disk.h"
+#include "joystick.h"
+#include "keyboard.h"
+#include "memory.h"
+#include "rewind.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "speaker.h"
+#include "video.h"
+#include "z80softcard.h"
+#include "../z80emu/z80emu.h"
+
+// everything that makes up one emulated Apple II.  Each module works
+// on the machine that is current on the calling thread (through the
+// module pointers like Memory and Video), so several machines can be
+// run side by side on different threads.  Read only tables like
+// the fonts and the floating bus addresses are built once and shared
+struct apple2_machine {
+	emulator_type      m_type;
+	uint64_t           m_total_cycles;              // master clock for the scheduler.  64 bits so it never wraps
+	uint32_t           m_total_cycles_this_frame;
+
+	cpu_6502           m_cpu;
+	Z80_STATE          m_z80_cpu;
+
+	memory_state       m_memory;
+	video_state        m_video;
+	disk_state         m_disk;
+	keyboard_state     m_keyboard;
+	speaker_state      m_speaker;
+	scheduler_state    m_scheduler;
+	joystick_state     m_joystick;
+	z80softcard_state  m_z80softcard;
+
+	snapshot_state     m_snapshot;                  // ram pages shared with the last snapshot
+	rewind_state       m_rewind;
+};
+
+// the machine running on this thread
+extern THREAD_LOCAL apple2_machine *Machine;
+
+// budgets and exit conditions for machine_run().  The run stops at the
+// first of these that is reached.  0 (and -1 for the pc) means unused
+struct machine_run_options {
+	uint64_t     m_max_cycles;
+	uint64_t     m_max_frames;
+	int32_t      m_exit_pc;
+	const char  *m_exit_text;      // stop when this shows up on the text screen
+};
+
+struct machine_run_result {
+	const char  *m_exit_reason;    // "exit_pc", "exit_text", "frames" or "cycles"
+	uint64_t     m_cycles;
+	uint64_t     m_frames;
+};
+
+apple2_machine *machine_create(emulator_type type);
+void machine_destroy(apple2_machine *machine);
+void machine_set_current(apple2_machine *machine);
+bool machine_type_from_name(const char *name, emulator_type &type);
+void machine_reset();
+machine_run_result machine_run(const machine_run_options &options);
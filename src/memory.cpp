@@ -26,171 +26,135 @@ SOFTWARE.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iomanip>
+#include <mutex>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 #include "apple2emu_defs.h"
 #include "apple2emu.h"
+#include "machine.h"
 #include "memory.h"
 #include "video.h"
 #include "debugger.h"
 #include "keyboard.h"
 #include "joystick.h"
 #include "speaker.h"
+#include "snapshot.h"
 
 
-// state of the memory card
-uint32_t Memory_state;
-
-// values for memory sizes
-static const int Memory_main_size = (48 * 1024);
-static const int Memory_rom_size = (16 * 1024);
-static const int Memory_switched_bank_size = (4 * 1024);
-static const int Memory_c000_rom_size = (4 * 1024);
-static const int Memory_extended_size = (8 * 1024);
-static const int Memory_aux_size = (48 * 1024);
-static const int Memory_expansion_rom_size = (2 * 1024);
-
-static const uint16_t Memory_page_size = 256;
-
-// and page values
-static const int Memory_num_main_pages = (Memory_main_size / Memory_page_size);
-static const int Memory_num_rom_pages = (Memory_rom_size / Memory_page_size);
-static const int Memory_num_bank_pages = (Memory_switched_bank_size / Memory_page_size);
-static const int Memory_num_internal_rom_pages = (Memory_c000_rom_size/ Memory_page_size);
-static const int Memory_num_extended_pages = (Memory_extended_size / Memory_page_size);
-static const int Memory_num_aux_pages = (Memory_aux_size / Memory_page_size);
-static const int Memory_num_expansion_rom_pages (Memory_expansion_rom_size / Memory_page_size);
+THREAD_LOCAL memory_state *Memory = nullptr;
 
 // iie roms are 16k in size.  c000 to cfff can have different
 // functions depending on iie soft switches
 static const int APPLE2E_ROM_SIZE = 0x4000;
 
-// information on peripheral slots.  Note that there are really
-// 8 slots in the apple.  1-7 are the normal slots but slot 0
-// was used for the ram card for the apple2/2+
-static const int Num_slots = 8;
-
-static soft_switch_function m_soft_switch_handlers[256];
-
-// Need handlers for reading/writing slot memory for some handlers
-static soft_switch_function m_slot_memory_handlers[Num_slots];
-
-// class to handle memory paging.  Simple wrapper class  to hold the
-// pointer and whether or not the page is write protected.  Memory
-// pages will be set up when emulator starts.  Pointers to a full set
-// of 64K will be stored and those pointers will point to memory_page(s)
-// depending on which soft switches have been set
-class memory_page {
-
-private:
-	bool     m_write_protected;
-	bool     m_dirty;
-	uint8_t* m_ptr;
-	uint8_t  m_opcodes[Memory_page_size];
-
-public:
-	memory_page() {};
-
-	// init sets up the pointer to the actually memory and initial
-	// write protect status
-	void init(uint8_t *ptr, bool write_protected) {
-		m_ptr = ptr;
-		m_write_protected = write_protected;
-		m_dirty = true;
-		for (auto i = 0; i < Memory_page_size; i++) {
-			m_opcodes[i] = 0xff;
-		}
-	}
-
-	// returns write protect status
-	bool const write_protected() const {
-		return m_write_protected;
-	}
-
-	bool const dirty() const {
-		return m_dirty;
-	}
-
-	// sets write protect status
-	void set_write_protected(bool write_protected) {
-		m_write_protected = write_protected;
-	}
-
-	// reads the value from the given page address
-	uint8_t read(const uint8_t addr, bool instruction = false) {
-		uint8_t val = *(m_ptr + addr);
-		if (instruction) {
-			m_opcodes[addr] = val;
-		}
-		return val;
+// regions of the address space that are paged as a unit.  When soft
+// switches change, only the regions depending on them are rebuilt
+static const uint32_t Memory_region_zero_page = (1 << 0);       // 0x0000 - 0x01ff
+static const uint32_t Memory_region_main = (1 << 1);            // 0x0200 - 0xbfff
+static const uint32_t Memory_region_slot_rom = (1 << 2);        // 0xc000 - 0xc7ff
+static const uint32_t Memory_region_high = (1 << 3);            // 0xd000 - 0xffff
+static const uint32_t Memory_region_80store_text = (1 << 4);    // 0x0400 - 0x07ff with 80STORE
+static const uint32_t Memory_region_80store_hires = (1 << 5);   // 0x2000 - 0x3fff with 80STORE
+static const uint32_t Memory_region_all = (1 << 6) - 1;
+
+// opcode start tracking for the debugger disassembly.  One bit per
+// 6502 address which is set when an opcode is fetched from that
+// address and cleared when the address is written.  Only allocated
+// while tracking is on.  Tracking forces every access through the
+// slow path so that the fast path never has to check for it
+static const int Memory_opcode_map_size = 0x10000 / 8;
+
+// video scanner address for every cycle of a frame, which is where
+// floating bus reads come from.  Indexed by hires, then by page 2
+// (when 80STORE is off), then by the cycle in the frame.  The table
+// never changes, so it is built once and shared by all machines
+static uint16_t Memory_floating_bus_addrs[2][2][Cycles_per_frame];
+static std::once_flag Memory_floating_bus_built;
+
+// all of the emulated memory lives in one arena so that the whole
+// machine can be saved or restored with a single copy.  The layout
+// is fixed and every region starts on a 4k boundary.  RAM comes
+// first so that the RAM alone is one contiguous block:
+//
+//   0x00000  main ram                 48k
+//   0x0c000  aux ram                  48k
+//   0x18000  ram card bank 1           4k
+//   0x19000  ram card bank 2           4k
+//   0x1a000  ram card extended ram     8k
+//   0x1c000  aux ram card bank 1       4k
+//   0x1d000  aux ram card bank 2       4k
+//   0x1e000  aux ram card extended     8k
+//   0x20000  rom                      16k
+//   0x24000  internal c000 rom (iie)   4k
+//   0x25000  expansion roms       8 x  2k
+//   0x29000  end
+static const uint32_t Memory_arena_main_offset = 0x00000;
+static const uint32_t Memory_arena_aux_offset = 0x0c000;
+static const uint32_t Memory_arena_bank1_offset = 0x18000;
+static const uint32_t Memory_arena_bank2_offset = 0x19000;
+static const uint32_t Memory_arena_extended_offset = 0x1a000;
+static const uint32_t Memory_arena_aux_bank1_offset = 0x1c000;
+static const uint32_t Memory_arena_aux_bank2_offset = 0x1d000;
+static const uint32_t Memory_arena_aux_extended_offset = 0x1e000;
+static const uint32_t Memory_arena_rom_offset = 0x20000;
+static const uint32_t Memory_arena_internal_rom_offset = 0x24000;
+static const uint32_t Memory_arena_expansion_rom_offset = 0x25000;
+
+static_assert(Memory_arena_rom_offset == Memory_arena_ram_size, "ram must come first in the memory arena");
+static_assert(Memory_arena_expansion_rom_offset + Num_slots * Memory_expansion_rom_size == Memory_arena_size, "memory arena layout doesn't add up");
+
+bool Memory_use_huge_pages = false;
+
+// allocate the memory arena.  Aligned to a 4k page (which covers cache
+// line alignment).  On linux the arena can be backed by transparent huge
+// pages, in which case the allocation is rounded up to a whole 2MB page
+static bool memory_alloc_arena()
+{
+#if defined(__linux__)
+	const size_t alignment = Memory_use_huge_pages ? Memory_huge_page_size : Memory_arena_alignment;
+	Memory->m_arena_alloc_size = (Memory_arena_size + alignment - 1) & ~(alignment - 1);
+	void *ptr = nullptr;
+	if (posix_memalign(&ptr, alignment, Memory->m_arena_alloc_size) != 0) {
+		return false;
 	}
+	if (Memory_use_huge_pages) {
+		madvise(ptr, Memory->m_arena_alloc_size, MADV_HUGEPAGE);
+	}
+	Memory->m_arena = static_cast<uint8_t *>(ptr);
+#elif defined(_WIN32) || defined(_WIN64)
+	Memory->m_arena_alloc_size = Memory_arena_size;
+	Memory->m_arena = static_cast<uint8_t *>(_aligned_malloc(Memory->m_arena_alloc_size, Memory_arena_alignment));
+#else
+	Memory->m_arena_alloc_size = Memory_arena_size;
+	void *ptr = nullptr;
+	if (posix_memalign(&ptr, Memory_arena_alignment, Memory->m_arena_alloc_size) == 0) {
+		Memory->m_arena = static_cast<uint8_t *>(ptr);
+	}
+#endif
+	return Memory->m_arena != nullptr;
+}
 
-	// get the opcode value for the given address
-	uint8_t read_opcode(const uint8_t addr) { return m_opcodes[addr]; }
-
-	// writes out a value
-	void write(const uint16_t addr, uint8_t val) {
-		*(m_ptr + addr) = val;
-		m_dirty = true;
-
-		// change opcode back to invalid value
-		m_opcodes[addr] = 0xff;
-	}
-};
+static void memory_free_arena()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	_aligned_free(Memory->m_arena);
+#else
+	free(Memory->m_arena);
+#endif
+	Memory->m_arena = nullptr;
+	Memory->m_arena_alloc_size = 0;
+}
 
-// main definition of memory pages for the emulator.  There is a
-// page array for each "type" of memory (i.e. main, rom, extended
-// auxilliary, etc).
-memory_page Memory_main_pages[Memory_num_main_pages];             // 192 pages - 48k
-memory_page Memory_rom_pages[Memory_num_rom_pages];               // 64 pages - 16k
-memory_page Memory_bank_pages[2][Memory_num_bank_pages];          // 16 pages - 4k
-memory_page Memory_extended_pages[Memory_num_extended_pages];     // 32 pages - 8k
-memory_page Memory_internal_rom_pages[Memory_num_internal_rom_pages]; // 16 page - 4k
-memory_page Memory_aux_pages[Memory_num_aux_pages];               // 16 page - 4k
-memory_page Memory_aux_bank_pages[2][Memory_num_bank_pages];      // 16 pages - 4k
-memory_page Memory_aux_extended_pages[Memory_num_extended_pages]; // 32 pages - 8k
-memory_page Memory_expansion_rom_pages[Num_slots][Memory_num_expansion_rom_pages];  // 8 pages - 2k
-
-memory_page *Memory_current_expansion_rom_pages; // this will be what is actively used
-
-// pointers for read/write pages.  These are the methods by
-// which memory reading and writing will be done.  We have
-// separate read/write arrays because the apple allows writing
-// to RAM banks while allowing reading from ROM area
-memory_page *Memory_read_pages[Memory_page_size];
-memory_page *Memory_write_pages[Memory_page_size];
-
-// Below are actually memory buffers.  The memory pointers for
-// all of the memory_pages(s) will point into these buffers
-
-// main buffer of 48k.
-static uint8_t *Memory_buffer = nullptr;
-
-// rom buffer - 16k.  For apple2, c000 - cfff
-// isn't loaded from rom image, but are only used
-// for soft switches.  For apple2e, the full
-// 16k will be loaded
-static uint8_t *Memory_rom_buffer = nullptr;
-
-// two buffers for 4k ram (bank1 and bank2)
-static uint8_t *Memory_bank1_buffer = nullptr;
-static uint8_t *Memory_bank2_buffer = nullptr;
-
-// one 12k buffer for extended ram
-static uint8_t *Memory_extended_buffer = nullptr;
-
-// buffer to hold internal rom from iie rom as
-static uint8_t *Memory_internal_rom_buffer = nullptr;
-
-// buffer for the aux memory.  Includes buffers for
-// bank switched RAM as well
-static uint8_t *Memory_aux_buffer = nullptr;
-static uint8_t *Memory_aux_bank1_buffer = nullptr;
-static uint8_t *Memory_aux_bank2_buffer = nullptr;
-static uint8_t *Memory_aux_extended_buffer = nullptr;
-
-// memory buffer space for expansion rom for peripherals
-static uint8_t *Memory_expansion_rom_buffer[Num_slots];
+// returns the memory arena.  See the layout above
+uint8_t *memory_get_arena()
+{
+	return Memory->m_arena;
+}
 
 static bool memory_load_from_filename(const char *filename, uint8_t *dest)
 {
@@ -207,7 +171,7 @@ static bool memory_load_from_filename(const char *filename, uint8_t *dest)
 	// 4k into another buffer for use when certain soft switches
 	// are used
 	if (buffer_size == APPLE2E_ROM_SIZE) {
-		fread(Memory_internal_rom_buffer, 1, Memory_c000_rom_size, fp);
+		fread(Memory->m_internal_rom_buffer, 1, Memory_c000_rom_size, fp);
 		buffer_size -= Memory_c000_rom_size;
 	}
 
@@ -221,17 +185,17 @@ static bool memory_load_from_filename(const char *filename, uint8_t *dest)
 // type of machine we are trying to initialize
 static void memory_load_rom_images()
 {
-	if (Emulator_type == emulator_type::APPLE2) {
-		memory_load_from_filename("roms/Apple2.rom", &Memory_rom_buffer[0x1000]);
+	if (Machine->m_type == emulator_type::APPLE2) {
+		memory_load_from_filename("roms/Apple2.rom", &Memory->m_rom_buffer[0x1000]);
 	}
-	else if (Emulator_type == emulator_type::APPLE2_PLUS) {
-		memory_load_from_filename("roms/Apple2_Plus.rom", &Memory_rom_buffer[0x1000]);
-	} else if (Emulator_type == emulator_type::APPLE2E) {
-		memory_load_from_filename("roms/Apple2e.rom", &Memory_rom_buffer[0x1000]);
-	} else if (Emulator_type == emulator_type::APPLE2E_ENHANCED) {
-		memory_load_from_filename("roms/Apple2e_Enhanced.rom", &Memory_rom_buffer[0x1000]);
+	else if (Machine->m_type == emulator_type::APPLE2_PLUS) {
+		memory_load_from_filename("roms/Apple2_Plus.rom", &Memory->m_rom_buffer[0x1000]);
+	} else if (Machine->m_type == emulator_type::APPLE2E) {
+		memory_load_from_filename("roms/Apple2e.rom", &Memory->m_rom_buffer[0x1000]);
+	} else if (Machine->m_type == emulator_type::APPLE2E_ENHANCED) {
+		memory_load_from_filename("roms/Apple2e_Enhanced.rom", &Memory->m_rom_buffer[0x1000]);
 	}
-	memory_load_from_filename("roms/DISK2.rom", &Memory_rom_buffer[0x600]);
+	memory_load_from_filename("roms/DISK2.rom", &Memory->m_rom_buffer[0x600]);
 }
 
 // initialize the memory buffer with "random" pattern.  I am
@@ -244,103 +208,105 @@ static void memory_load_rom_images()
 // anymore on which to test
 static void memory_initialize()
 {
-	memset(Memory_buffer, 0, 0xc000);
+	memset(Memory->m_buffer, 0, 0xc000);
 	for (auto i = 0; i < 0xc000; i += 4) {
-		Memory_buffer[i] = 0xff;
-		Memory_buffer[i + 1] = 0xff;
+		Memory->m_buffer[i] = 0xff;
+		Memory->m_buffer[i + 1] = 0xff;
 	}
 
 	// same with bank  buffers
 	for (auto i = 0; i < Memory_switched_bank_size; i += 4) {
-		Memory_bank1_buffer[i] = 0xff;
-		Memory_bank1_buffer[i + 1] = 0xff;
-		Memory_bank2_buffer[i] = 0xff;
-		Memory_bank2_buffer[i + 1] = 0xff;
+		Memory->m_bank1_buffer[i] = 0xff;
+		Memory->m_bank1_buffer[i + 1] = 0xff;
+		Memory->m_bank2_buffer[i] = 0xff;
+		Memory->m_bank2_buffer[i + 1] = 0xff;
 	}
 
 	// same with extended buffer
 	for (auto i = 0; i < Memory_extended_size; i += 4) {
-		Memory_extended_buffer[i] = 0xff;
-		Memory_extended_buffer[i + 1] = 0xff;
+		Memory->m_extended_buffer[i] = 0xff;
+		Memory->m_extended_buffer[i + 1] = 0xff;
 	}
 }
 
+// WOOHOO -- reads of c00X are the keyboard read
+static uint8_t memory_keyboard_read(void *context, uint16_t addr)
+{
+	UNREFERENCED(context);
+	UNREFERENCED(addr);
+	return keyboard_read();
+}
+
 // handler for writing to 0xc00X for memory state
-uint8_t memory_set_state(uint16_t addr, uint8_t val, bool write)
+static void memory_set_state(void *context, uint16_t addr, uint8_t val)
 {
+	UNREFERENCED(context);
 	UNREFERENCED(val);
-	UNREFERENCED(write);
-	uint8_t return_val = 0;
 
 	addr = addr & 0x0f;
-	// WOOHOO -- c00X is used as keyboard read so let's just deal with that
-	// here
-	if (write == false) {
-		return keyboard_read();
-	}
-
-	auto old_state = Memory_state;
+	auto old_state = Memory->m_state;
 
 	switch(addr) {
 	case 0x00:
-		Memory_state &= ~RAM_80STORE;
+		Memory->m_state &= ~RAM_80STORE;
 		break;
 	case 0x01:
-		Memory_state |= RAM_80STORE;
+		Memory->m_state |= RAM_80STORE;
 		break;
 	case 0x02:
-		Memory_state &= ~RAM_AUX_MEMORY_READ;
+		Memory->m_state &= ~RAM_AUX_MEMORY_READ;
 		break;
 	case 0x03:
-		Memory_state |= RAM_AUX_MEMORY_READ;
+		Memory->m_state |= RAM_AUX_MEMORY_READ;
 		break;
 	case 0x04:
-		Memory_state &= ~RAM_AUX_MEMORY_WRITE;
+		Memory->m_state &= ~RAM_AUX_MEMORY_WRITE;
 		break;
 	case 0x05:
-		Memory_state |= RAM_AUX_MEMORY_WRITE;
+		Memory->m_state |= RAM_AUX_MEMORY_WRITE;
 		break;
 	case 0x06:
 		// this is opposite of the 2e refernece manual.  Other sources
 		// suggest the manual is in error
-		Memory_state |= RAM_SLOTCX_ROM;
+		Memory->m_state |= RAM_SLOTCX_ROM;
 		break;
 	case 0x07:
 		// this is opposite of the 2e refernece manual.  Other sources
 		// suggest the manual is in error
-		Memory_state &= ~RAM_SLOTCX_ROM;
+		Memory->m_state &= ~RAM_SLOTCX_ROM;
 		break;
 	case 0x08:
-		Memory_state &= ~RAM_ALT_ZERO_PAGE;
+		Memory->m_state &= ~RAM_ALT_ZERO_PAGE;
 		break;
 	case 0x09:
-		Memory_state |= RAM_ALT_ZERO_PAGE;
+		Memory->m_state |= RAM_ALT_ZERO_PAGE;
 		break;
 	case 0x0a:
-		Memory_state &= ~RAM_SLOTC3_ROM;
+		Memory->m_state &= ~RAM_SLOTC3_ROM;
 		break;
 	case 0x0b:
-		Memory_state |= RAM_SLOTC3_ROM;
+		Memory->m_state |= RAM_SLOTC3_ROM;
 		break;
 	}
 
-	if (old_state != Memory_state) {
-		memory_set_paging_tables();
-	}
+	memory_update_paging_tables(old_state, Video->m_mode);
+}
 
-	return return_val;
+// writes to 0xc01x reset the keyboard strobe
+static void memory_keyboard_clear(void *context, uint16_t addr, uint8_t val)
+{
+	UNREFERENCED(context);
+	UNREFERENCED(addr);
+	UNREFERENCED(val);
+	keyboard_clear();
 }
 
 // handler for reading memory status.  This handles 0xc010 to 0xc018
-uint8_t memory_get_state(uint16_t addr, uint8_t val, bool write)
+static uint8_t memory_get_state(void *context, uint16_t addr)
 {
+	UNREFERENCED(context);
 	uint8_t return_val = 0xff;
 
-	// writes to 0xc01x reset the keyboard strobe
-	if (write == true) {
-		return keyboard_clear();
-	}
-
 	addr = addr & 0xff;
 	switch(addr) {
 	case 0x10:
@@ -348,30 +314,30 @@ uint8_t memory_get_state(uint16_t addr, uint8_t val, bool write)
 		keyboard_clear();
 		break;
 	case 0x11:
-		return_val = Memory_state & RAM_CARD_BANK2 ? 1 : 0;
+		return_val = Memory->m_state & RAM_CARD_BANK2 ? 1 : 0;
 		break;
 	case 0x12:
-		return_val = Memory_state & RAM_CARD_READ ? 1 : 0;
+		return_val = Memory->m_state & RAM_CARD_READ ? 1 : 0;
 		break;
 	case 0x13:   // RAMRD switch
-		return_val = Memory_state & RAM_AUX_MEMORY_READ ? 1 : 0;
+		return_val = Memory->m_state & RAM_AUX_MEMORY_READ ? 1 : 0;
 		break;
 	case 0x14:   // RAMWRT switch
-		return_val = Memory_state & RAM_AUX_MEMORY_WRITE ? 1 : 0;
+		return_val = Memory->m_state & RAM_AUX_MEMORY_WRITE ? 1 : 0;
 		break;
 	case 0x15:   // SLOTCXROM switch
 		// note the return values here.  0 means that slot
 		// roms are active and 1 means internal rom
-		return_val = Memory_state & RAM_SLOTCX_ROM ? 0 : 1;
+		return_val = Memory->m_state & RAM_SLOTCX_ROM ? 0 : 1;
 		break;
 	case 0x16:   // ALTZP switch
-		return_val = Memory_state & RAM_ALT_ZERO_PAGE ? 1 : 0;
+		return_val = Memory->m_state & RAM_ALT_ZERO_PAGE ? 1 : 0;
 		break;
 	case 0x17:   // SLOTC3ROM
-		return_val = Memory_state & RAM_SLOTC3_ROM ? 1 : 0;
+		return_val = Memory->m_state & RAM_SLOTC3_ROM ? 1 : 0;
 		break;
 	case 0x18:   // 80STORE switch
-		return_val = Memory_state & RAM_80STORE ? 1 : 0;
+		return_val = Memory->m_state & RAM_80STORE ? 1 : 0;
 		break;
 	case 0x19:
 	case 0x1a:
@@ -380,14 +346,14 @@ uint8_t memory_get_state(uint16_t addr, uint8_t val, bool write)
 	case 0x1d:
 	case 0x1e:
 	case 0x1f:
-		return_val = video_get_state(addr, val, write);
+		return_val = video_get_state(addr);
 		break;
 	}
 
 	if (return_val) {
 		return 0x80;
 	}
-	return val;
+	return 0;
 }
 
 // Read/write handler for the memory expansion card in SLOT 0.  A 16K
@@ -401,12 +367,9 @@ uint8_t memory_get_state(uint16_t addr, uint8_t val, bool write)
 //
 // http://apple2online.com/web_documents/Apple%20IIe%20Technical%20Reference%20Manual%20KB.pdf
 //
-static uint8_t memory_expansion_soft_switch_handler(uint16_t addr, uint8_t val, bool write)
+static void memory_expansion_soft_switch(uint16_t addr)
 {
-	UNREFERENCED(write);
-	UNREFERENCED(val);
-
-	static uint8_t last_access = 0;
+	auto old_state = Memory->m_state;
 
 	addr = addr & 0xff;
 	switch (addr) {
@@ -414,84 +377,84 @@ static uint8_t memory_expansion_soft_switch_handler(uint16_t addr, uint8_t val,
 		// cases for bank 2
 	case 0x80:
 	case 0x84:
-		Memory_state |= RAM_CARD_READ;
-		Memory_state |= RAM_CARD_BANK2;
-		Memory_state |= RAM_CARD_WRITE_PROTECT;
-		last_access = 0;
+		Memory->m_state |= RAM_CARD_READ;
+		Memory->m_state |= RAM_CARD_BANK2;
+		Memory->m_state |= RAM_CARD_WRITE_PROTECT;
+		Memory->m_expansion_last_access = 0;
 		break;
 	case 0x81:
 	case 0x85:
-		Memory_state &= ~RAM_CARD_READ;
-		Memory_state |= RAM_CARD_BANK2;
-		Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-		if (last_access) {
-			Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-			last_access = 0;
+		Memory->m_state &= ~RAM_CARD_READ;
+		Memory->m_state |= RAM_CARD_BANK2;
+		Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+		if (Memory->m_expansion_last_access) {
+			Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+			Memory->m_expansion_last_access = 0;
 		}
 		else {
-			last_access = 1;
+			Memory->m_expansion_last_access = 1;
 		}
 		break;
 	case 0x82:
 	case 0x86:
-		Memory_state &= ~RAM_CARD_READ;
-		Memory_state |= RAM_CARD_BANK2;
-		Memory_state |= RAM_CARD_WRITE_PROTECT;
-		last_access = 0;
+		Memory->m_state &= ~RAM_CARD_READ;
+		Memory->m_state |= RAM_CARD_BANK2;
+		Memory->m_state |= RAM_CARD_WRITE_PROTECT;
+		Memory->m_expansion_last_access = 0;
 		break;
 	case 0x83:
 	case 0x87:
-		Memory_state |= RAM_CARD_READ;
-		Memory_state |= RAM_CARD_BANK2;
-		Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-		if (last_access) {
-			Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-			last_access = 0;
+		Memory->m_state |= RAM_CARD_READ;
+		Memory->m_state |= RAM_CARD_BANK2;
+		Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+		if (Memory->m_expansion_last_access) {
+			Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+			Memory->m_expansion_last_access = 0;
 		}
 		else {
-			last_access = 1;
+			Memory->m_expansion_last_access = 1;
 		}
 		break;
 
 		// cases for bank 1
 	case 0x88:
 	case 0x8c:
-		Memory_state |= RAM_CARD_READ;
-		Memory_state &= ~RAM_CARD_BANK2;
-		Memory_state |= RAM_CARD_WRITE_PROTECT;
-		last_access = 0;
+		Memory->m_state |= RAM_CARD_READ;
+		Memory->m_state &= ~RAM_CARD_BANK2;
+		Memory->m_state |= RAM_CARD_WRITE_PROTECT;
+		Memory->m_expansion_last_access = 0;
 		break;
 	case 0x89:
 	case 0x8d:
-		Memory_state &= ~RAM_CARD_READ;
-		Memory_state &= ~RAM_CARD_BANK2;
-		Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-		if (last_access) {
-			Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-			last_access = 0;
+		Memory->m_state &= ~RAM_CARD_READ;
+		Memory->m_state &= ~RAM_CARD_BANK2;
+		Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+		if (Memory->m_expansion_last_access) {
+			Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+			Memory->m_expansion_last_access = 0;
 		}
 		else {
-			last_access = 1;
+			Memory->m_expansion_last_access = 1;
 		}
 		break;
 	case 0x8a:
 	case 0x8e:
-		Memory_state &= ~RAM_CARD_READ;
-		Memory_state &= ~RAM_CARD_BANK2;
-		Memory_state |= RAM_CARD_WRITE_PROTECT;
-		last_access = 0;
+		Memory->m_state &= ~RAM_CARD_READ;
+		Memory->m_state &= ~RAM_CARD_BANK2;
+		Memory->m_state |= RAM_CARD_WRITE_PROTECT;
+		Memory->m_expansion_last_access = 0;
 		break;
 	case 0x8b:
 	case 0x8f:
-		Memory_state |= RAM_CARD_READ;
-		Memory_state &= ~RAM_CARD_BANK2;
-		Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-		if (last_access) {
-			Memory_state &= ~RAM_CARD_WRITE_PROTECT;
-			last_access = 0;
+		Memory->m_state |= RAM_CARD_READ;
+		Memory->m_state &= ~RAM_CARD_BANK2;
+		Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+		if (Memory->m_expansion_last_access) {
+			Memory->m_state &= ~RAM_CARD_WRITE_PROTECT;
+			Memory->m_expansion_last_access = 0;
 		}
 		else {
-			last_access = 1;
+			Memory->m_expansion_last_access = 1;
 		}
 		break;
 	default:
@@ -499,151 +462,310 @@ static uint8_t memory_expansion_soft_switch_handler(uint16_t addr, uint8_t val,
 	}
 
 	// set write protect on ramcard pages if necessary.  Total of 48 pages
-	auto bank = Memory_state & RAM_CARD_BANK2 ? 1 : 0;
+	auto bank = Memory->m_state & RAM_CARD_BANK2 ? 1 : 0;
 	for (auto i = 0; i < Memory_num_bank_pages; i++) {
-		Memory_bank_pages[bank][i].set_write_protected(Memory_state & RAM_CARD_WRITE_PROTECT ? true : false);
+		Memory->m_bank_pages[bank][i].set_write_protected(Memory->m_state & RAM_CARD_WRITE_PROTECT ? true : false);
 	}
 	for (auto i = 0; i < Memory_num_extended_pages; i++) {
-		Memory_extended_pages[i].set_write_protected(Memory_state & RAM_CARD_WRITE_PROTECT ? true : false);
+		Memory->m_extended_pages[i].set_write_protected(Memory->m_state & RAM_CARD_WRITE_PROTECT ? true : false);
 	}
 
 	// set up paging pointers
-	memory_set_paging_tables();
+	memory_update_paging_tables(old_state, Video->m_mode);
+}
 
-	if (write) {
-		return 0;
-	}
+// reads and writes of the expansion card switches do the same thing
+static uint8_t memory_expansion_soft_switch_read(void *context, uint16_t addr)
+{
+	UNREFERENCED(context);
+	memory_expansion_soft_switch(addr);
 	return memory_read_floating_bus();
 }
 
-// set up the paging table pointers based on the current memory
-// setup.
-void memory_set_paging_tables()
+static void memory_expansion_soft_switch_write(void *context, uint16_t addr, uint8_t val)
 {
-	// set up the zero pages
-	for (auto i = 0; i < 2; i++) {
-		if (Memory_state & RAM_ALT_ZERO_PAGE) {
-			Memory_read_pages[i] = &Memory_aux_pages[i];
-			Memory_write_pages[i] = &Memory_aux_pages[i];
+	UNREFERENCED(context);
+	UNREFERENCED(val);
+	memory_expansion_soft_switch(addr);
+}
+
+// rebuild the flat tables for the fast path from the page pointers
+// for pages first to last - 1.  Pages which need special handling on
+// access are left as nullptr so that they go through the slow path:
+//   - 0xc0 is memory mapped I/O
+//   - 0xc1-0xcf on the 2e switch expansion rom on reads.  Writes to
+//     0xc1-0xcf go to slot memory handlers or are ignored (rom)
+//   - write protected pages
+static void memory_update_fast_pages(int first, int last)
+{
+	for (auto page = first; page < last; page++) {
+		memory_page *read_page = Memory->m_read_pages[page];
+		memory_page *write_page = Memory->m_write_pages[page];
+		bool slow_read = (page == 0xc0) || (Machine->m_type >= emulator_type::APPLE2E && page >= 0xc1 && page <= 0xcf);
+		bool slow_write = (page >= 0xc0 && page <= 0xcf);
+
+		if (Memory->m_opcode_map != nullptr) {
+			slow_read = slow_write = true;
+		}
+
+		if (read_page == nullptr || slow_read) {
+			Memory->m_read_ptrs[page] = nullptr;
+		} else {
+			Memory->m_read_ptrs[page] = read_page->ptr();
+		}
+
+		if (write_page == nullptr || slow_write || write_page->write_protected()) {
+			Memory->m_write_ptrs[page] = nullptr;
 		} else {
-			Memory_read_pages[i] = &Memory_main_pages[i];
-			Memory_write_pages[i] = &Memory_main_pages[i];
+			Memory->m_write_ptrs[page] = write_page->ptr();
 		}
 	}
+	Memory->m_paging_stats.m_pages += last - first;
+}
 
-	// set up the main 48k.  Skip the first two pages because
-	// these will be set based on the alt zp switch (previous
-	// set of code)
-	for (auto page = 2; page < Memory_num_main_pages; page++) {
-		if (Memory_state & RAM_AUX_MEMORY_READ) {
-			Memory_read_pages[page] = &Memory_aux_pages[page];
+// main 48k pages between first and last - 1.  Follows the aux
+// read and write switches
+static void memory_set_main_pages(int first, int last)
+{
+	for (auto page = first; page < last; page++) {
+		if (Memory->m_state & RAM_AUX_MEMORY_READ) {
+			Memory->m_read_pages[page] = &Memory->m_aux_pages[page];
 		} else {
-			Memory_read_pages[page] = &Memory_main_pages[page];
+			Memory->m_read_pages[page] = &Memory->m_main_pages[page];
 		}
 
-		if (Memory_state & RAM_AUX_MEMORY_WRITE) {
-			Memory_write_pages[page] = &Memory_aux_pages[page];
+		if (Memory->m_state & RAM_AUX_MEMORY_WRITE) {
+			Memory->m_write_pages[page] = &Memory->m_aux_pages[page];
 		} else {
-			Memory_write_pages[page] = &Memory_main_pages[page];
+			Memory->m_write_pages[page] = &Memory->m_main_pages[page];
 		}
 	}
+	memory_update_fast_pages(first, last);
+}
 
-	// set up c000 - 0xc7ff.  Set to internal rom (apple 2e) or
-	// slot rom depending on slot flag
-	for (auto page = 0xc0; page < 0xc8; page++) {
-		if (Memory_state & RAM_SLOTCX_ROM) {
-			Memory_read_pages[page] = &Memory_rom_pages[page - 0xc0];
-			Memory_write_pages[page] = &Memory_rom_pages[page - 0xc0];
+// one of the 80 column windows (text page 1 or hires page 1).  When
+// 80STORE is on and the window is active, page2 selects between
+// main and aux memory for the window.  Otherwise the window is just
+// ordinary main memory
+static void memory_set_80store_pages(int first, int last, bool active)
+{
+	if (!(Memory->m_state & RAM_80STORE) || active == false) {
+		memory_set_main_pages(first, last);
+		return;
+	}
+
+	for (auto page = first; page < last; page++) {
+		if (Video->m_mode & VIDEO_MODE_PAGE2) {
+			Memory->m_read_pages[page] = &Memory->m_aux_pages[page];
+			Memory->m_write_pages[page] = &Memory->m_aux_pages[page];
 		} else {
-			Memory_read_pages[page] = &Memory_internal_rom_pages[page - 0xc0];
-			Memory_write_pages[page] = &Memory_internal_rom_pages[page - 0xc0];
+			Memory->m_read_pages[page] = &Memory->m_main_pages[page];
+			Memory->m_write_pages[page] = &Memory->m_main_pages[page];
 		}
 	}
+	memory_update_fast_pages(first, last);
+}
 
-	// check to see if slot3 page should be remapped
-	if (!(Memory_state & RAM_SLOTC3_ROM)) {
-		Memory_read_pages[0xc3] = &Memory_internal_rom_pages[3];
+// set up the paging table pointers for the given regions of memory
+// based on the current memory setup.
+static void memory_set_paging_regions(uint32_t regions)
+{
+	if (regions == 0) {
+		Memory->m_paging_stats.m_skipped++;
+		return;
 	}
+	Memory->m_paging_stats.m_updates++;
 
-	// extended RAM/ROM section.
-	auto bank = Memory_state & RAM_CARD_BANK2 ? 1 : 0;
-
-	for (auto page = 0xd0; page < 0xe0; page++) {
-		if (Memory_state & RAM_CARD_READ) {
-			if (Memory_state & RAM_ALT_ZERO_PAGE) {
-				Memory_read_pages[page] = &Memory_aux_bank_pages[bank][page - 0xd0];
-				Memory_write_pages[page] = &Memory_aux_bank_pages[bank][page - 0xd0];
-			} else {
-				Memory_read_pages[page] = &Memory_bank_pages[bank][page - 0xd0];
-				Memory_write_pages[page] = &Memory_bank_pages[bank][page - 0xd0];
-			}
-		} else {
-			// offset is 0xc0 here because rom pages start at page 0xc0
-			Memory_read_pages[page] = &Memory_rom_pages[page - 0xc0];
-			if (Memory_state & RAM_CARD_WRITE_PROTECT) {
-				Memory_write_pages[page] = &Memory_rom_pages[page - 0xc0];
+	// set up the zero pages
+	if (regions & Memory_region_zero_page) {
+		for (auto i = 0; i < 2; i++) {
+			if (Memory->m_state & RAM_ALT_ZERO_PAGE) {
+				Memory->m_read_pages[i] = &Memory->m_aux_pages[i];
+				Memory->m_write_pages[i] = &Memory->m_aux_pages[i];
 			} else {
-				Memory_write_pages[page] = &Memory_bank_pages[bank][page - 0xd0];
+				Memory->m_read_pages[i] = &Memory->m_main_pages[i];
+				Memory->m_write_pages[i] = &Memory->m_main_pages[i];
 			}
 		}
+		memory_update_fast_pages(0x00, 0x02);
 	}
 
-	for (auto page = 0xe0; page < 0x100; page++) {
-		if (Memory_state & RAM_CARD_READ) {
-			if (Memory_state & RAM_ALT_ZERO_PAGE) {
-				Memory_read_pages[page] = &Memory_aux_extended_pages[page - 0xe0];
-				Memory_write_pages[page] = &Memory_aux_extended_pages[page - 0xe0];
-			} else {
-				Memory_read_pages[page] = &Memory_extended_pages[page - 0xe0];
-				Memory_write_pages[page] = &Memory_extended_pages[page - 0xe0];
-			}
+	// set up the main 48k.  Skip the first two pages because
+	// these will be set based on the alt zp switch (previous
+	// set of code).  The 80 column windows are part of this
+	// range, so they need to be redone if 80STORE is on
+	if (regions & Memory_region_main) {
+		memory_set_main_pages(0x02, Memory_num_main_pages);
+		if (Memory->m_state & RAM_80STORE) {
+			regions |= Memory_region_80store_text | Memory_region_80store_hires;
 		} else {
-			// offset is 0xc0 here because rom pages start at page 0xc0
-			Memory_read_pages[page] = &Memory_rom_pages[page - 0xc0];
-			if (Memory_state & RAM_CARD_WRITE_PROTECT) {
-				Memory_write_pages[page] = &Memory_rom_pages[page - 0xc0];
+			regions &= ~(Memory_region_80store_text | Memory_region_80store_hires);
+		}
+	}
+
+	// deal with page pointers for 80 column moide
+	if (regions & Memory_region_80store_text) {
+		memory_set_80store_pages(0x04, 0x08, true);
+	}
+	if (regions & Memory_region_80store_hires) {
+		memory_set_80store_pages(0x20, 0x40, (Video->m_mode & VIDEO_MODE_HIRES) != 0);
+	}
+
+	// set up c000 - 0xc7ff.  Set to internal rom (apple 2e) or
+	// slot rom depending on slot flag.  0xc800 - 0xcfff is paged
+	// by the expansion rom handling in memory_read_slow()
+	if (regions & Memory_region_slot_rom) {
+		for (auto page = 0xc0; page < 0xc8; page++) {
+			if (Memory->m_state & RAM_SLOTCX_ROM) {
+				Memory->m_read_pages[page] = &Memory->m_rom_pages[page - 0xc0];
+				Memory->m_write_pages[page] = &Memory->m_rom_pages[page - 0xc0];
 			} else {
-				Memory_write_pages[page] = &Memory_extended_pages[page - 0xe0];
+				Memory->m_read_pages[page] = &Memory->m_internal_rom_pages[page - 0xc0];
+				Memory->m_write_pages[page] = &Memory->m_internal_rom_pages[page - 0xc0];
 			}
 		}
+
+		// check to see if slot3 page should be remapped
+		if (!(Memory->m_state & RAM_SLOTC3_ROM)) {
+			Memory->m_read_pages[0xc3] = &Memory->m_internal_rom_pages[3];
+		}
+		memory_update_fast_pages(0xc0, 0xc8);
 	}
 
-	// deal with page pointers for 80 column moide
-	if (Memory_state & RAM_80STORE) {
-		for (auto page = 0x04; page < 0x08; page++) {
-			if (Video_mode & VIDEO_MODE_PAGE2) {
-				Memory_read_pages[page] = &Memory_aux_pages[page];
-				Memory_write_pages[page] = &Memory_aux_pages[page];
+	// extended RAM/ROM section.
+	if (regions & Memory_region_high) {
+		auto bank = Memory->m_state & RAM_CARD_BANK2 ? 1 : 0;
+
+		for (auto page = 0xd0; page < 0xe0; page++) {
+			if (Memory->m_state & RAM_CARD_READ) {
+				if (Memory->m_state & RAM_ALT_ZERO_PAGE) {
+					Memory->m_read_pages[page] = &Memory->m_aux_bank_pages[bank][page - 0xd0];
+					Memory->m_write_pages[page] = &Memory->m_aux_bank_pages[bank][page - 0xd0];
+				} else {
+					Memory->m_read_pages[page] = &Memory->m_bank_pages[bank][page - 0xd0];
+					Memory->m_write_pages[page] = &Memory->m_bank_pages[bank][page - 0xd0];
+				}
 			} else {
-				Memory_read_pages[page] = &Memory_main_pages[page];
-				Memory_write_pages[page] = &Memory_main_pages[page];
+				// offset is 0xc0 here because rom pages start at page 0xc0
+				Memory->m_read_pages[page] = &Memory->m_rom_pages[page - 0xc0];
+				if (Memory->m_state & RAM_CARD_WRITE_PROTECT) {
+					Memory->m_write_pages[page] = &Memory->m_rom_pages[page - 0xc0];
+				} else {
+					Memory->m_write_pages[page] = &Memory->m_bank_pages[bank][page - 0xd0];
+				}
 			}
 		}
 
-		if (Video_mode & VIDEO_MODE_HIRES) {
-			for (auto page = 0x20; page < 0x40; page++) {
-				if (Video_mode & VIDEO_MODE_PAGE2) {
-					Memory_read_pages[page] = &Memory_aux_pages[page];
-					Memory_write_pages[page] = &Memory_aux_pages[page];
+		for (auto page = 0xe0; page < 0x100; page++) {
+			if (Memory->m_state & RAM_CARD_READ) {
+				if (Memory->m_state & RAM_ALT_ZERO_PAGE) {
+					Memory->m_read_pages[page] = &Memory->m_aux_extended_pages[page - 0xe0];
+					Memory->m_write_pages[page] = &Memory->m_aux_extended_pages[page - 0xe0];
+				} else {
+					Memory->m_read_pages[page] = &Memory->m_extended_pages[page - 0xe0];
+					Memory->m_write_pages[page] = &Memory->m_extended_pages[page - 0xe0];
+				}
+			} else {
+				// offset is 0xc0 here because rom pages start at page 0xc0
+				Memory->m_read_pages[page] = &Memory->m_rom_pages[page - 0xc0];
+				if (Memory->m_state & RAM_CARD_WRITE_PROTECT) {
+					Memory->m_write_pages[page] = &Memory->m_rom_pages[page - 0xc0];
 				} else {
-					Memory_read_pages[page] = &Memory_main_pages[page];
-					Memory_write_pages[page] = &Memory_main_pages[page];
+					Memory->m_write_pages[page] = &Memory->m_extended_pages[page - 0xe0];
 				}
 			}
 		}
+		memory_update_fast_pages(0xd0, 0x100);
 	}
 }
 
+// set up all of the paging table pointers based on the current
+// memory setup.
+void memory_set_paging_tables()
+{
+	memory_set_paging_regions(Memory_region_all);
+}
+
+// update the paging tables after soft switches changed.  Only the
+// regions that depend on the memory state or video mode bits that
+// changed get rebuilt.
+void memory_update_paging_tables(uint32_t old_memory_state, uint8_t old_video_mode)
+{
+	uint32_t changed_state = old_memory_state ^ Memory->m_state;
+	uint8_t changed_mode = old_video_mode ^ Video->m_mode;
+	uint32_t regions = 0;
+
+	if (changed_state & RAM_ALT_ZERO_PAGE) {
+		// the language card area also follows alt zp
+		regions |= Memory_region_zero_page | Memory_region_high;
+	}
+	if (changed_state & (RAM_AUX_MEMORY_READ | RAM_AUX_MEMORY_WRITE)) {
+		regions |= Memory_region_main;
+	}
+	if (changed_state & (RAM_SLOTCX_ROM | RAM_SLOTC3_ROM)) {
+		regions |= Memory_region_slot_rom;
+	}
+	if (changed_state & (RAM_CARD_READ | RAM_CARD_BANK2 | RAM_CARD_WRITE_PROTECT)) {
+		regions |= Memory_region_high;
+	}
+	if (changed_state & RAM_80STORE) {
+		regions |= Memory_region_80store_text | Memory_region_80store_hires;
+	}
+
+	// page2 and hires only matter to paging when 80STORE is on
+	if (Memory->m_state & RAM_80STORE) {
+		if (changed_mode & VIDEO_MODE_PAGE2) {
+			regions |= Memory_region_80store_text | Memory_region_80store_hires;
+		}
+		if (changed_mode & VIDEO_MODE_HIRES) {
+			regions |= Memory_region_80store_hires;
+		}
+	}
+
+	memory_set_paging_regions(regions);
+}
+
+// move the paging counters for the frame that just finished over
+// to the last frame counters
+void memory_end_frame()
+{
+	Memory->m_paging_stats_last_frame = Memory->m_paging_stats;
+	Memory->m_paging_stats = memory_paging_stats();
+}
+
 uint8_t memory_read_aux(const uint16_t addr)
 {
 	auto page = (addr / Memory_page_size);
-	return Memory_aux_pages[page].read(addr & 0xff);
+	return Memory->m_aux_pages[page].read(addr & 0xff);
 }
 
 uint8_t memory_read_main(const uint16_t addr)
 {
 	auto page = (addr / Memory_page_size);
-	return Memory_main_pages[page].read(addr & 0xff);
+	return Memory->m_main_pages[page].read(addr & 0xff);
+}
+
+// host pointers to the start of the page holding addr.  The read
+// page is whatever the 6502 would currently read from, main and aux
+// ignore the paging soft switches.  Used by video to find and track
+// where the screen comes from
+const uint8_t *memory_get_read_page(const uint16_t addr)
+{
+	auto page = (addr / Memory_page_size);
+	SDL_assert(Memory->m_read_pages[page] != nullptr);
+	return Memory->m_read_pages[page]->ptr();
+}
+
+const uint8_t *memory_get_main_page(const uint16_t addr)
+{
+	auto page = (addr / Memory_page_size);
+	return Memory->m_main_pages[page].ptr();
+}
+
+const uint8_t *memory_get_aux_page(const uint16_t addr)
+{
+	auto page = (addr / Memory_page_size);
+	return Memory->m_aux_pages[page].ptr();
 }
 
 // read memory, but use the read types to get the value to
@@ -658,60 +780,63 @@ uint8_t memory_read(const uint16_t addr, memory_high_read_type high_type, memory
 	// for rom reading, just get what's in rom
 	if (addr >= 0xc000) {
 		if (high_type == memory_high_read_type::READ_ROM) {
-			page_ptr = &Memory_rom_pages[page - 0xc0];
+			page_ptr = &Memory->m_rom_pages[page - 0xc0];
 		} else {
 			// this is ram, so we need to figure out which bank
 			if (page < 0xe0) {
 				int bank_num = static_cast<int>(bank);
-				page_ptr = &Memory_bank_pages[bank_num][page - 0xd0];
+				page_ptr = &Memory->m_bank_pages[bank_num][page - 0xd0];
 			} else {
-				page_ptr = &Memory_extended_pages[page - 0xe0];
+				page_ptr = &Memory->m_extended_pages[page - 0xe0];
 			}
 		}
 	} else {
-		page_ptr = Memory_read_pages[page];
+		page_ptr = Memory->m_read_pages[page];
 	}
 	return page_ptr->read(addr & 0xff);
 }
 
-uint8_t memory_read(const uint16_t addr, bool instruction)
+// slow path for memory reads.  Handles I/O and expansion rom paging
+// for pages that don't have a fast path pointer
+uint8_t memory_read_slow(const uint16_t addr, bool instruction)
 {
 	auto page = (addr / Memory_page_size);
 
 	// look for memory mapped I/O locations
 	if (page == 0xc0) {
-		uint8_t mapped_addr = addr & 0xff;
-		if (m_soft_switch_handlers[mapped_addr] != nullptr) {
-			return m_soft_switch_handlers[mapped_addr](addr, 0, false);
+		Memory->m_access_count++;
+		const memory_io_read_handler &handler = Memory->m_io_read_handlers[addr & 0xff];
+		if (handler.m_func != nullptr) {
+			return handler.m_func(handler.m_context, addr);
 		}
-		if (Memory_read_pages[page] == nullptr) {
+		if (Memory->m_read_pages[page] == nullptr) {
 			return 0xff;
 		}
 	}
 
 	// reset rom expansion page settings
-	if (Emulator_type >= emulator_type::APPLE2E) {
+	if (Machine->m_type >= emulator_type::APPLE2E) {
 		if (addr == 0xcfff) {
 			// read to 0xcfff resets the expansion rom area
-			Memory_state |= RAM_EXPANSION_RESET;
-			Memory_current_expansion_rom_pages = nullptr;
+			Memory->m_state |= RAM_EXPANSION_RESET;
+			Memory->m_current_expansion_rom_pages = nullptr;
 		}
 
 		// handle reads in perhiperal rom (or internal rom) memory
-		else if (page >= 0xc1 && page <= 0xc7 && Memory_current_expansion_rom_pages == nullptr) {
+		else if (page >= 0xc1 && page <= 0xc7 && Memory->m_current_expansion_rom_pages == nullptr) {
 
 			// check to see if we need to update the expansion ROM area.  Access
 			// to a peripheral slot means that we _might_ access the expansion
 			// rom.  Set flags to indicate what pages might need to be paged
 			// in if that expansion area is accessed.
 			auto slot = (page & 0xf);
-			if (Memory_expansion_rom_buffer[slot] != nullptr) {
-				Memory_current_expansion_rom_pages = &Memory_expansion_rom_pages[slot][0];
+			if (Memory->m_expansion_rom_buffer[slot] != nullptr) {
+				Memory->m_current_expansion_rom_pages = &Memory->m_expansion_rom_pages[slot][0];
 			}
-			else if (slot == 3 && !(Memory_state & RAM_SLOTC3_ROM)) {
-				Memory_current_expansion_rom_pages = &Memory_internal_rom_pages[0x8];
+			else if (slot == 3 && !(Memory->m_state & RAM_SLOTC3_ROM)) {
+				Memory->m_current_expansion_rom_pages = &Memory->m_internal_rom_pages[0x8];
 			} else {
-				Memory_current_expansion_rom_pages = &Memory_internal_rom_pages[0x8];
+				Memory->m_current_expansion_rom_pages = &Memory->m_internal_rom_pages[0x8];
 			}
 		}
 
@@ -724,65 +849,57 @@ uint8_t memory_read(const uint16_t addr, bool instruction)
 			// just use the internal rom.  If reset is active and a slot
 			// is active, use the slot's expansion rom (or internal rom
 			// if this is slot 3)
-			if (Memory_state & RAM_EXPANSION_RESET) {
-				if (Memory_current_expansion_rom_pages == nullptr) {
-					Memory_current_expansion_rom_pages = &Memory_internal_rom_pages[0x8];
+			if (Memory->m_state & RAM_EXPANSION_RESET) {
+				if (Memory->m_current_expansion_rom_pages == nullptr) {
+					Memory->m_current_expansion_rom_pages = &Memory->m_internal_rom_pages[0x8];
 				}
 				// this is a reset case and we just point to the internal rom pages
 				for (auto i = 0xc8; i <= 0xcf; i++) {
-					Memory_read_pages[i] = &Memory_current_expansion_rom_pages[i - 0xc8];
+					Memory->m_read_pages[i] = &Memory->m_current_expansion_rom_pages[i - 0xc8];
 				}
-				Memory_state &= ~RAM_EXPANSION_RESET;
+				Memory->m_state &= ~RAM_EXPANSION_RESET;
 			}
 		}
 	} else {
 		// apple2 plus, is there is no expansion rom.  If there is no
 		// handler for the page, then just return
 		if (page >= 0xc0 && page <= 0xcf) {
-			if (Memory_read_pages[page] == nullptr) {
+			if (Memory->m_read_pages[page] == nullptr) {
 				return 0xff;
 			}
 		}
 	}
 
-	SDL_assert(Memory_read_pages[page] != nullptr);
-	return Memory_read_pages[page]->read(addr & 0xff, instruction);
+	SDL_assert(Memory->m_read_pages[page] != nullptr);
+	if (instruction && Memory->m_opcode_map != nullptr) {
+		Memory->m_opcode_map[addr >> 3] |= (1 << (addr & 7));
+	}
+	return Memory->m_read_pages[page]->read(addr & 0xff);
 }
 
 // finds the nth previous opcode from the current
 // address.
 uint16_t memory_find_previous_opcode_addr(const uint16_t addr, int num)
 {
-	auto page = (addr / Memory_page_size);
-	uint8_t mapped_addr = addr & 0xff;
-	uint8_t last_valid_address = mapped_addr;
-	auto last_valid_page = page;
-	int num_invalid = 0;
-	while (page >= 0) {
-		for (uint8_t a = mapped_addr - 1; a !=0xff; a--) {
-			uint8_t opcode = Memory_read_pages[page]->read_opcode(a);
-			if (opcode != 0xff) {
-				num--;
-				last_valid_address = a;
-				last_valid_page = page;
-				num_invalid = 0;
-				if (num == 0) {
-					return (uint16_t)((page * 256) + a);
-				}
-			}
+	if (Memory->m_opcode_map == nullptr) {
+		return addr;
+	}
 
-			// if we get 4 invalid opcodes, then we can't proceed any further
-			// back so return the last known good address that we had.
-			else {
-				num_invalid++;
-				if (num_invalid == 4) {
-					return (uint16_t)((last_valid_page * 256) + last_valid_address);
-				}
+	// instructions are at most 3 bytes, so 4 addresses in a row without
+	// an opcode start means we can't proceed any further back.  That
+	// bounds the work to a few bit tests per opcode.
+	uint16_t last_valid_address = addr;
+	int num_invalid = 0;
+	for (int a = addr - 1; a >= 0; a--) {
+		if (Memory->m_opcode_map[a >> 3] & (1 << (a & 7))) {
+			last_valid_address = static_cast<uint16_t>(a);
+			num_invalid = 0;
+			if (--num == 0) {
+				return last_valid_address;
 			}
+		} else if (++num_invalid == 4) {
+			return last_valid_address;
 		}
-		// go to previous page to the last memory location
-		page--;
-		mapped_addr = 0xff;
 	}
 
 	// ugh - we get here, then we have nothing, which would be really
@@ -791,17 +908,39 @@ uint16_t memory_find_previous_opcode_addr(const uint16_t addr, int num)
 	return 0xffff;
 }
 
-// read the floating bus.  Based on the scanner address.  See inside the
-// Apple ][ (or ][e) in the memory section on generating the scanner
-// address.  Understanding the Apple ][e chapters 3 and 5 give
-// the information here to calculate the bus value.
-//
-// TODO:  could this be table driven?
-//
-uint8_t memory_read_floating_bus()
+// turn opcode start tracking for the debugger on or off.  The
+// bitmap starts out empty each time tracking is turned on
+void memory_set_opcode_tracking(bool on)
 {
-	int current_cycles = Total_cycles_this_frame % Cycles_per_frame;
+	if (on == true && Memory->m_opcode_map == nullptr) {
+		Memory->m_opcode_map = new uint8_t[Memory_opcode_map_size];
+		memset(Memory->m_opcode_map, 0, Memory_opcode_map_size);
+	} else if (on == false && Memory->m_opcode_map != nullptr) {
+		delete[] Memory->m_opcode_map;
+		Memory->m_opcode_map = nullptr;
+	} else {
+		return;
+	}
+
+	// the fast path pointers depend on the tracking state
+	memory_update_fast_pages(0, 0x100);
+}
+
+// a write to an address means it no longer holds a known opcode
+static void memory_clear_opcode(const uint16_t addr)
+{
+	if (Memory->m_opcode_map != nullptr) {
+		Memory->m_opcode_map[addr >> 3] &= ~(1 << (addr & 7));
+	}
+}
 
+// compute the video scanner address for a cycle in the frame.  See
+// inside the Apple ][ (or ][e) in the memory section on generating the
+// scanner address.  Understanding the Apple ][e chapters 3 and 5 give
+// the information here to calculate the address.  This is only used to
+// build the floating bus tables
+static uint16_t memory_calc_scanner_addr(uint32_t current_cycles, bool hires, bool p2_80_not)
+{
 	// calculate the horizontal scanning clock.
 	int horz_clock = (current_cycles + Horz_hpe_start) % Horz_state_counter;
 	int horz_state = Horz_clock_start + horz_clock;
@@ -851,12 +990,10 @@ uint8_t memory_read_floating_bus()
 	addr |= v_1 << 8;
 	addr |= v_2 << 9;
 
-	// need to get page 2 and 80store states to help determine address
-	int p2_80_not = (Video_mode & VIDEO_MODE_PAGE2) && !(Memory_state & RAM_80STORE);
 	int not_p2_80_not = !p2_80_not;
 
 	// text/lores and hires scanning
-	if (Video_mode & VIDEO_MODE_HIRES) {
+	if (hires) {
 		addr |= v_a << 10;
 		addr |= v_b << 11;
 		addr |= v_c << 12;
@@ -867,9 +1004,31 @@ uint8_t memory_read_floating_bus()
 		addr |= p2_80_not << 11;
 	}
 
-	// this is temporary to make sure that I'm getting these
-	// addresses calculated properly
+	// the scanner never generates addresses in the I/O page
 	SDL_assert((addr >> 8) != 0xc0);
+	return addr;
+}
+
+// build the scanner address tables
+static void memory_build_floating_bus_tables()
+{
+	for (auto hires = 0; hires < 2; hires++) {
+		for (auto page2 = 0; page2 < 2; page2++) {
+			for (uint32_t cycle = 0; cycle < Cycles_per_frame; cycle++) {
+				Memory_floating_bus_addrs[hires][page2][cycle] = memory_calc_scanner_addr(cycle, hires != 0, page2 != 0);
+			}
+		}
+	}
+}
+
+// read the floating bus, which is whatever the video scanner
+// is reading at the moment.
+uint8_t memory_read_floating_bus()
+{
+	// need to get page 2 and 80store states to help determine address
+	int p2_80_not = (Video->m_mode & VIDEO_MODE_PAGE2) && !(Memory->m_state & RAM_80STORE);
+	int hires = (Video->m_mode & VIDEO_MODE_HIRES) ? 1 : 0;
+	uint16_t addr = Memory_floating_bus_addrs[hires][p2_80_not][Machine->m_total_cycles_this_frame % Cycles_per_frame];
 
 	// make sure hit bit not set as it may need to get set
 	// somehwere else
@@ -877,47 +1036,55 @@ uint8_t memory_read_floating_bus()
 }
 
 // function to write value to memory.  Trapped here in order to
-// faciliate memory mapped I/O and other similar things
-void memory_write(const uint16_t addr, uint8_t val)
+// faciliate memory mapped I/O and other similar things.  This is the
+// slow path for pages which don't have a fast path pointer
+void memory_write_slow(const uint16_t addr, uint8_t val)
 {
 	auto page = (addr / Memory_page_size);
+	Memory->m_access_count++;
 
 	if (page == 0xc0) {
-		uint8_t mapped_addr = addr & 0xff;
-		if (m_soft_switch_handlers[mapped_addr] != nullptr) {
-			m_soft_switch_handlers[mapped_addr](addr, val, true);
+		const memory_io_write_handler &handler = Memory->m_io_write_handlers[addr & 0xff];
+		if (handler.m_func != nullptr) {
+			handler.m_func(handler.m_context, addr, val);
 			return;
 		}
-		if (Memory_write_pages[page] == nullptr) {
+		if (Memory->m_write_pages[page] == nullptr) {
 			return;
 		}
 	}
 
 	// check for handlers for slot memory
-	if (page >= 0xc1 && page <= 0xc8) {
-		uint8_t slot = page & 0x0f;
-		if (m_slot_memory_handlers[slot] != nullptr) {
-			m_slot_memory_handlers[slot](addr, val, true);
+	if (page >= 0xc1 && page <= 0xc7) {
+		const memory_io_write_handler &handler = Memory->m_slot_memory_handlers[page & 0x0f];
+		if (handler.m_func != nullptr) {
+			handler.m_func(handler.m_context, addr, val);
 			return;
 		}
 	}
 
 
-	SDL_assert(Memory_write_pages[page] != nullptr);
-	if (Memory_write_pages[page]->write_protected()) {
+	SDL_assert(Memory->m_write_pages[page] != nullptr);
+	if (Memory->m_write_pages[page]->write_protected()) {
 		return;
 	}
 
-	Memory_write_pages[page]->write(addr & 0xff, val);
+	Memory->m_write_pages[page]->write(addr & 0xff, val);
+	memory_dirty_flag(Memory->m_write_pages[page]->ptr()) = Memory_dirty_all;
+	memory_clear_opcode(addr);
 }
 
-void memory_register_soft_switch_handler(const uint8_t addr, soft_switch_function func)
+// register read/write handlers for one of the 0xc0XX soft switches
+void memory_register_soft_switch_handler(const uint8_t addr, io_read_function read_func, io_write_function write_func, void *context)
 {
-	m_soft_switch_handlers[addr] = func;
+	Memory->m_io_read_handlers[addr].m_func = read_func;
+	Memory->m_io_read_handlers[addr].m_context = context;
+	Memory->m_io_write_handlers[addr].m_func = write_func;
+	Memory->m_io_write_handlers[addr].m_context = context;
 }
 
-// register handlers for the I/O slots
-void memory_register_slot_handler(const uint8_t slot, soft_switch_function func, uint8_t *expansion_rom)
+// register a card in one of the I/O slots
+void memory_register_slot_handler(const uint8_t slot, const slot_device &device)
 {
 	SDL_assert((slot >= 0) && (slot < Num_slots));
 	uint8_t addr = 0x80 + (slot << 4);
@@ -925,20 +1092,22 @@ void memory_register_slot_handler(const uint8_t slot, soft_switch_function func,
 	// add handlers for the slot.  There are 16 addresses per slot so set them all to the same
 	// handler as we will deal with all slot operations in the same function
 	for (auto i = 0; i <= 0xf; i++) {
-		m_soft_switch_handlers[addr + i] = func;
+		memory_register_soft_switch_handler(addr + i, device.m_io_read, device.m_io_write, device.m_context);
 	}
 
-	if (expansion_rom != nullptr) {
-		Memory_expansion_rom_buffer[slot] = expansion_rom;
-	}
-}
+	// memory handlers for slot memory (needed for things like z80 card)
+	Memory->m_slot_memory_handlers[slot].m_func = device.m_memory_write;
+	Memory->m_slot_memory_handlers[slot].m_context = device.m_context;
 
-// register memory read/write handlers for slot memory (needed for things like
-// z80 card)
-void memory_register_slot_memory_handler(const uint8_t slot, soft_switch_function func)
-{
-	SDL_assert((slot >= 0) && (slot < Num_slots));
-	m_slot_memory_handlers[slot] = func;
+	// the expansion rom is copied into the slot's area of the arena
+	if (device.m_expansion_rom != nullptr) {
+		uint8_t *rom = &Memory->m_arena[Memory_arena_expansion_rom_offset + slot * Memory_expansion_rom_size];
+		memcpy(rom, device.m_expansion_rom, Memory_expansion_rom_size);
+		for (auto i = 0; i < Memory_num_expansion_rom_pages; i++) {
+			Memory->m_expansion_rom_pages[slot][i].init(&rom[i * Memory_page_size], true);
+		}
+		Memory->m_expansion_rom_buffer[slot] = rom;
+	}
 }
 
 bool memory_load_buffer(uint8_t *buffer, uint16_t size, uint16_t location)
@@ -948,7 +1117,9 @@ bool memory_load_buffer(uint8_t *buffer, uint16_t size, uint16_t location)
 	// read/write status of the pages
 	for (int addr = location; addr < location + size; addr++) {
 		auto page = (addr / Memory_page_size);
-		Memory_write_pages[page]->write(addr & 0xff, buffer[addr - location]);
+		Memory->m_write_pages[page]->write(addr & 0xff, buffer[addr - location]);
+		memory_dirty_flag(Memory->m_write_pages[page]->ptr()) = Memory_dirty_all;
+		memory_clear_opcode(addr);
 	}
 	return true;
 }
@@ -956,134 +1127,111 @@ bool memory_load_buffer(uint8_t *buffer, uint16_t size, uint16_t location)
 // initliaze the memory subsystem
 void memory_init()
 {
-	// main memory buffer - 48k
-	if (Memory_buffer == nullptr) {
-		Memory_buffer = new uint8_t[Memory_main_size];
-	}
-	memset(Memory_buffer, 0, Memory_main_size);
-
-	// main ROM buffer - 16k
-	if (Memory_rom_buffer == nullptr) {
-		Memory_rom_buffer = new uint8_t[Memory_rom_size];
-	}
-	memset(Memory_rom_buffer, 0xff, Memory_rom_size);
-
-	// memory for c000-cfff rom (used in apple2e).  Holds
-	// the c000-cfff rom from the rom images which gets
-	// used depending on soft switches
-	if (Memory_internal_rom_buffer == nullptr) {
-		Memory_internal_rom_buffer = new uint8_t[Memory_c000_rom_size];
-	}
-	memset(Memory_internal_rom_buffer, 0, Memory_c000_rom_size);
+	Memory->m_access_count = 0;
+
+	// all of the memory buffers are carved out of the arena, which
+	// only needs to be allocated once
+	if (Memory->m_arena == nullptr) {
+		if (memory_alloc_arena() == false) {
+			printf("Unable to allocate %u bytes for emulated memory\n", Memory_arena_size);
+			exit(-1);
+		}
+		Memory->m_buffer = &Memory->m_arena[Memory_arena_main_offset];
+		Memory->m_aux_buffer = &Memory->m_arena[Memory_arena_aux_offset];
+		Memory->m_bank1_buffer = &Memory->m_arena[Memory_arena_bank1_offset];
+		Memory->m_bank2_buffer = &Memory->m_arena[Memory_arena_bank2_offset];
+		Memory->m_extended_buffer = &Memory->m_arena[Memory_arena_extended_offset];
+		Memory->m_aux_bank1_buffer = &Memory->m_arena[Memory_arena_aux_bank1_offset];
+		Memory->m_aux_bank2_buffer = &Memory->m_arena[Memory_arena_aux_bank2_offset];
+		Memory->m_aux_extended_buffer = &Memory->m_arena[Memory_arena_aux_extended_offset];
+		Memory->m_rom_buffer = &Memory->m_arena[Memory_arena_rom_offset];
+		Memory->m_internal_rom_buffer = &Memory->m_arena[Memory_arena_internal_rom_offset];
+	}
+
+	// all of ram starts out cleared.  main ROM is 0xff where there
+	// is no rom image loaded and the internal rom (used in apple2e) is
+	// cleared.  The internal rom holds the c000-cfff rom from the rom
+	// images which gets used depending on soft switches
+	memset(Memory->m_arena, 0, Memory_arena_ram_size);
+	memset(Memory->m_rom_buffer, 0xff, Memory_rom_size);
+	memset(Memory->m_internal_rom_buffer, 0, Memory_c000_rom_size);
+	memset(&Memory->m_arena[Memory_arena_expansion_rom_offset], 0xff, Num_slots * Memory_expansion_rom_size);
 
 	// load rom images based on the type of machine we are starting
 	memory_load_rom_images();
 
-	// allocate ram for banks in extended ram
-	if (Memory_bank1_buffer == nullptr) {
-		Memory_bank1_buffer = new uint8_t[Memory_switched_bank_size];
-	}
-	if (Memory_bank2_buffer == nullptr) {
-	  Memory_bank2_buffer = new uint8_t[Memory_switched_bank_size];
-	}
-	memset(Memory_bank1_buffer, 0, Memory_switched_bank_size);
-	memset(Memory_bank2_buffer, 0, Memory_switched_bank_size);
-
-	// This is the 12k buffer that is active for either bank
-	// 1 or bank 2
-	if (Memory_extended_buffer == nullptr) {
-	  Memory_extended_buffer = new uint8_t[Memory_extended_size];
-	}
-	memset(Memory_extended_buffer, 0, Memory_extended_size);
-
-	// alternate zero page buffer
-	if (Memory_aux_buffer == nullptr) {
-		Memory_aux_buffer = new uint8_t[Memory_aux_size];
-	}
-	memset(Memory_aux_buffer, 0, Memory_aux_size);
-
-	// and banks for aux memory
-	if (Memory_aux_bank1_buffer == nullptr) {
-		Memory_aux_bank1_buffer = new uint8_t[Memory_switched_bank_size];
-	}
-	if (Memory_aux_bank2_buffer == nullptr) {
-	  Memory_aux_bank2_buffer = new uint8_t[Memory_switched_bank_size];
-	}
-	memset(Memory_aux_bank1_buffer, 0, Memory_switched_bank_size);
-	memset(Memory_aux_bank2_buffer, 0, Memory_switched_bank_size);
-
-	// This is the 12k buffer that is active for either bank
-	// 1 or bank 2
-	if (Memory_aux_extended_buffer == nullptr) {
-	  Memory_aux_extended_buffer = new uint8_t[Memory_extended_size];
-	}
-	memset(Memory_aux_extended_buffer, 0, Memory_extended_size);
-
 	for (auto i = 0; i < Num_slots; i++) {
-		Memory_expansion_rom_buffer[i] = nullptr;
+		Memory->m_expansion_rom_buffer[i] = nullptr;
 	}
 
 	// initialize memory with "random" pattern.  there was long discussion
 	// in applewin github issues tracker related to what to do about
 	// memory initialization.  https://github.com/AppleWin/AppleWin/issues/206
 	memory_initialize();
+	memset(Memory->m_dirty_pages, Memory_dirty_all, sizeof(Memory->m_dirty_pages));
+	std::call_once(Memory_floating_bus_built, memory_build_floating_bus_tables);
+
+	// memory contents are all new, so forget any opcodes we have seen
+	if (Memory->m_opcode_map != nullptr) {
+		memset(Memory->m_opcode_map, 0, Memory_opcode_map_size);
+	}
 
 	// main memory area page pointers.  This is not write protected.  There
 	// are
 	for (auto i = 0; i < Memory_num_main_pages; i++) {
-		Memory_main_pages[i].init(&Memory_buffer[i * Memory_page_size], false);
+		Memory->m_main_pages[i].init(&Memory->m_buffer[i * Memory_page_size], false);
 	}
 
 	// ROM area.  This is write protected
 	for (auto i = 0; i < Memory_num_rom_pages; i++) {
-		Memory_rom_pages[i].init(&Memory_rom_buffer[i * Memory_page_size], true);
+		Memory->m_rom_pages[i].init(&Memory->m_rom_buffer[i * Memory_page_size], true);
 	}
 
 	// set up pointers for ramcard pages
 	for (auto i = 0; i < Memory_num_bank_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_bank_pages[0][i].init(&Memory_bank1_buffer[addr], false);
-		Memory_bank_pages[1][i].init(&Memory_bank2_buffer[addr], false);
+		Memory->m_bank_pages[0][i].init(&Memory->m_bank1_buffer[addr], false);
+		Memory->m_bank_pages[1][i].init(&Memory->m_bank2_buffer[addr], false);
 	}
 
 	// final 12k, the page pointers are the same.  Offset 8k into extended memory
 	// buffer because we have 2 4k pages before that
 	for (auto i = 0; i < Memory_num_extended_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_extended_pages[i].init(&Memory_extended_buffer[addr], false);
+		Memory->m_extended_pages[i].init(&Memory->m_extended_buffer[addr], false);
 	}
 
 	// set up pages for internal ROM on apple iie
 	for (auto i = 0; i < Memory_num_internal_rom_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_internal_rom_pages[i].init(&Memory_internal_rom_buffer[addr], true);
+		Memory->m_internal_rom_pages[i].init(&Memory->m_internal_rom_buffer[addr], true);
 	}
 
 	// memory for the auxiliary ram
 	for (auto i = 0; i < Memory_num_aux_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_aux_pages[i].init(&Memory_aux_buffer[addr], false);
+		Memory->m_aux_pages[i].init(&Memory->m_aux_buffer[addr], false);
 	}
 
 	// set up pointers for auxiliary bank pages
 	for (auto i = 0; i < Memory_num_bank_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_aux_bank_pages[0][i].init(&Memory_aux_bank1_buffer[addr], false);
-		Memory_aux_bank_pages[1][i].init(&Memory_aux_bank2_buffer[addr], false);
+		Memory->m_aux_bank_pages[0][i].init(&Memory->m_aux_bank1_buffer[addr], false);
+		Memory->m_aux_bank_pages[1][i].init(&Memory->m_aux_bank2_buffer[addr], false);
 	}
 
 	// final 12k of exnteded RAM in the auxiliary buffer
 	for (auto i = 0; i < Memory_num_extended_pages; i++) {
 		uint32_t addr = i * Memory_page_size;
-		Memory_aux_extended_pages[i].init(&Memory_aux_extended_buffer[addr], false);
+		Memory->m_aux_extended_pages[i].init(&Memory->m_aux_extended_buffer[addr], false);
 	}
 
 	// set up the main memory card state.  Make sure to set the
 	// reset expansion rom flag so that the expansion rom gets
 	// reset to the internal rom (for the apple2e)
-	Memory_state = RAM_CARD_BANK2 | RAM_SLOTCX_ROM | RAM_EXPANSION_RESET;
-	if (Emulator_type < emulator_type::APPLE2E) {
-		Memory_state |= RAM_CARD_WRITE_PROTECT;
+	Memory->m_state = RAM_CARD_BANK2 | RAM_SLOTCX_ROM | RAM_EXPANSION_RESET;
+	if (Machine->m_type < emulator_type::APPLE2E) {
+		Memory->m_state |= RAM_CARD_WRITE_PROTECT;
 	}
 
 	// update paging based on the current memory configuration.  this
@@ -1092,107 +1240,234 @@ void memory_init()
 	memory_set_paging_tables();
 
 	for (auto i = 0; i < Memory_num_main_pages; i++) {
-		Memory_read_pages[i] = &Memory_main_pages[i];
-		Memory_write_pages[i] = &Memory_main_pages[i];
+		Memory->m_read_pages[i] = &Memory->m_main_pages[i];
+		Memory->m_write_pages[i] = &Memory->m_main_pages[i];
 	}
+	memory_update_fast_pages(0, Memory_num_main_pages);
 
 	for (auto i = 0; i < 256; i++) {
-		m_soft_switch_handlers[i] = nullptr;
+		memory_register_soft_switch_handler(i, nullptr, nullptr);
 	}
 
 	for (auto i = 0; i < Num_slots; i++) {
-		m_slot_memory_handlers[i] = nullptr;
+		Memory->m_slot_memory_handlers[i].m_func = nullptr;
+		Memory->m_slot_memory_handlers[i].m_context = nullptr;
 	}
 
 	// register handlers for 0xc000 to 0xc00c.  These are memory
 	// management switches (except for the read of 0xc000 which is
 	// reading the keyboard).
 	for (uint8_t i = 0; i < 0x0c; i++) {
-		memory_register_soft_switch_handler(i, memory_set_state);
+		memory_register_soft_switch_handler(i, memory_keyboard_read, memory_set_state);
 	}
 	for (uint8_t i = 0x0c; i < 0x10; i++) {
-		memory_register_soft_switch_handler(i, video_set_state);
+		memory_register_soft_switch_handler(i, video_soft_switch_read, video_soft_switch_write);
 	}
 
 	// register handler for reading memory status
 	for (uint8_t i = 0x10; i < 0x20; i++) {
-		memory_register_soft_switch_handler(i, memory_get_state);
+		memory_register_soft_switch_handler(i, memory_get_state, memory_keyboard_clear);
 	}
 
 	// register 0xc030 for the speaker
-	memory_register_soft_switch_handler(0x30, speaker_soft_switch_handler);
+	memory_register_soft_switch_handler(0x30, speaker_soft_switch_read, speaker_soft_switch_write);
 
 	// set up memory handlers for video
 	for (uint8_t i = 0x50; i <= 0x57; i++) {
-		memory_register_soft_switch_handler(i, video_set_state);
+		memory_register_soft_switch_handler(i, video_soft_switch_read, video_soft_switch_write);
 	}
+	memory_register_soft_switch_handler(0x5e, video_soft_switch_read, video_soft_switch_write);
+	memory_register_soft_switch_handler(0x5f, video_soft_switch_read, video_soft_switch_write);
 
 	// register the read/write handlers for the joystick
 	for (uint8_t i = 0x61; i < 0x67; i++) {
-		memory_register_soft_switch_handler(i, joystick_soft_switch_handler);
+		memory_register_soft_switch_handler(i, joystick_soft_switch_read, joystick_soft_switch_write);
 	}
-	memory_register_soft_switch_handler(0x70, joystick_soft_switch_handler);
+	memory_register_soft_switch_handler(0x70, joystick_soft_switch_read, joystick_soft_switch_write);
 
 	// register a handler for memory expansion card in slot 0.  This handler will
 	// also handle the first 64K in the apple iie
-	memory_register_slot_handler(0, memory_expansion_soft_switch_handler);
+	slot_device expansion_card = {};
+	expansion_card.m_io_read = memory_expansion_soft_switch_read;
+	expansion_card.m_io_write = memory_expansion_soft_switch_write;
+	memory_register_slot_handler(0, expansion_card);
 }
 
 // for z80 testing from command line.  Just striaght 64k block of ram
 void memory_init_for_z80_test()
 {
 	for (auto i = 0; i < 256; i++) {
-		m_soft_switch_handlers[i] = nullptr;
+		memory_register_soft_switch_handler(i, nullptr, nullptr);
 	}
 	for (auto i = 0; i < Memory_num_main_pages; i++) {
-		Memory_read_pages[i] = &Memory_main_pages[i];
-		Memory_write_pages[i] = &Memory_main_pages[i];
+		Memory->m_read_pages[i] = &Memory->m_main_pages[i];
+		Memory->m_write_pages[i] = &Memory->m_main_pages[i];
 	}
 	for (auto i = 0xc0; i < 0xd0; i++) {
-		Memory_rom_pages[i - 0xc0].set_write_protected(false);
-		Memory_read_pages[i] = &Memory_rom_pages[i - 0xc0];
-		Memory_write_pages[i] = &Memory_rom_pages[i - 0xc0];
+		Memory->m_rom_pages[i - 0xc0].set_write_protected(false);
+		Memory->m_read_pages[i] = &Memory->m_rom_pages[i - 0xc0];
+		Memory->m_write_pages[i] = &Memory->m_rom_pages[i - 0xc0];
 	}
+	memory_update_fast_pages(0, 0x100);
 
-	Memory_buffer[0] = 0xd3;       /* OUT N, A */
-	Memory_buffer[1] = 0x00;
+	Memory->m_buffer[0] = 0xd3;       /* OUT N, A */
+	Memory->m_buffer[1] = 0x00;
 
-	Memory_buffer[5] = 0xdb;       /* IN A, N */
-	Memory_buffer[6] = 0x00;
-	Memory_buffer[7] = 0xc9;       /* RET */
+	Memory->m_buffer[5] = 0xdb;       /* IN A, N */
+	Memory->m_buffer[6] = 0x00;
+	Memory->m_buffer[7] = 0xc9;       /* RET */
 }
 
-void memory_shutdown()
-{
-	if (Memory_buffer != nullptr) {
-		delete[] Memory_buffer;
+// every memory_page the paging tables can point at, so that page
+// pointers can be saved as indices into the list
+static const int Memory_max_page_arrays = 9;
+static const uint16_t Memory_no_page = 0xffff;
+
+struct memory_page_list {
+	memory_page *m_arrays[Memory_max_page_arrays];
+	uint16_t     m_counts[Memory_max_page_arrays];
+	int          m_num_arrays;
+
+	void add(memory_page *pages, int count) {
+		m_arrays[m_num_arrays] = pages;
+		m_counts[m_num_arrays++] = static_cast<uint16_t>(count);
 	}
-	if (Memory_rom_buffer != nullptr) {
-		delete[] Memory_rom_buffer;
+
+	uint16_t to_index(const memory_page *page) const {
+		uint16_t index = 0;
+		for (auto i = 0; i < m_num_arrays; i++) {
+			if (page >= m_arrays[i] && page < m_arrays[i] + m_counts[i]) {
+				return index + static_cast<uint16_t>(page - m_arrays[i]);
+			}
+			index += m_counts[i];
+		}
+		return Memory_no_page;
 	}
-	if (Memory_internal_rom_buffer != nullptr) {
-		delete[] Memory_internal_rom_buffer;
+
+	memory_page *from_index(uint16_t index) const {
+		for (auto i = 0; i < m_num_arrays; i++) {
+			if (index < m_counts[i]) {
+				return &m_arrays[i][index];
+			}
+			index -= m_counts[i];
+		}
+		return nullptr;
 	}
-	if (Memory_bank1_buffer != nullptr) {
-		delete[] Memory_bank1_buffer;
+};
+
+static void memory_get_page_list(memory_page_list &list)
+{
+	list.m_num_arrays = 0;
+	list.add(Memory->m_main_pages, Memory_num_main_pages);
+	list.add(Memory->m_rom_pages, Memory_num_rom_pages);
+	list.add(&Memory->m_bank_pages[0][0], 2 * Memory_num_bank_pages);
+	list.add(Memory->m_extended_pages, Memory_num_extended_pages);
+	list.add(Memory->m_internal_rom_pages, Memory_num_internal_rom_pages);
+	list.add(Memory->m_aux_pages, Memory_num_aux_pages);
+	list.add(&Memory->m_aux_bank_pages[0][0], 2 * Memory_num_bank_pages);
+	list.add(Memory->m_aux_extended_pages, Memory_num_extended_pages);
+	list.add(&Memory->m_expansion_rom_pages[0][0], Num_slots * Memory_num_expansion_rom_pages);
+}
+
+static const int Memory_total_pages = Memory_num_main_pages + Memory_num_rom_pages + 2 * Memory_num_bank_pages +
+	Memory_num_extended_pages + Memory_num_internal_rom_pages + Memory_num_aux_pages + 2 * Memory_num_bank_pages +
+	Memory_num_extended_pages + Num_slots * Memory_num_expansion_rom_pages;
+
+// save the soft switch state and paging tables.  The contents of ram
+// are saved by the snapshot code itself, and the roms come from the
+// machine type.  Tables are gathered up and written in one go since
+// this is done for every snapshot
+void memory_save_state(snapshot_writer &writer)
+{
+	memory_page_list list;
+	memory_get_page_list(list);
+
+	uint16_t read_pages[Memory_page_size];
+	uint16_t write_pages[Memory_page_size];
+	for (auto i = 0; i < Memory_page_size; i++) {
+		read_pages[i] = list.to_index(Memory->m_read_pages[i]);
+		write_pages[i] = list.to_index(Memory->m_write_pages[i]);
 	}
-	if (Memory_bank2_buffer != nullptr) {
-		delete[] Memory_bank2_buffer;
+
+	bool write_protected[Memory_total_pages];
+	for (uint16_t i = 0; i < Memory_total_pages; i++) {
+		write_protected[i] = list.from_index(i)->write_protected();
 	}
-	if (Memory_extended_buffer != nullptr) {
-		delete[] Memory_extended_buffer;
+
+	writer.write(Memory->m_state);
+	writer.write(Memory->m_expansion_last_access);
+	writer.write(list.to_index(Memory->m_current_expansion_rom_pages));
+	writer.write(read_pages);
+	writer.write(write_pages);
+	writer.write(write_protected);
+}
+
+void memory_load_state(snapshot_reader &reader)
+{
+	memory_page_list list;
+	memory_get_page_list(list);
+
+	uint32_t state;
+	uint8_t expansion_last_access;
+	uint16_t current_expansion_rom_pages;
+	uint16_t read_pages[Memory_page_size];
+	uint16_t write_pages[Memory_page_size];
+	bool write_protected[Memory_total_pages];
+	reader.read(state);
+	reader.read(expansion_last_access);
+	reader.read(current_expansion_rom_pages);
+	reader.read(read_pages);
+	reader.read(write_pages);
+	reader.read(write_protected);
+
+	// check every index before changing anything, so that a damaged save
+	// state leaves the tables as they were.  Only pages above main memory
+	// can be left without a page, and the expansion roms are switched in
+	// as a whole slot (or the internal roms) at a time
+	memory_page *expansion_rom_pages = list.from_index(current_expansion_rom_pages);
+	bool valid = current_expansion_rom_pages == Memory_no_page || expansion_rom_pages == &Memory->m_internal_rom_pages[0x8];
+	for (auto slot = 0; slot < Num_slots; slot++) {
+		valid = valid || expansion_rom_pages == &Memory->m_expansion_rom_pages[slot][0];
+	}
+	for (auto i = 0; i < Memory_page_size; i++) {
+		bool main_page = i < Memory_num_main_pages;
+		if (list.from_index(read_pages[i]) == nullptr && (main_page || read_pages[i] != Memory_no_page)) {
+			valid = false;
+		}
+		if (list.from_index(write_pages[i]) == nullptr && (main_page || write_pages[i] != Memory_no_page)) {
+			valid = false;
+		}
 	}
-	if (Memory_aux_buffer != nullptr) {
-		delete[] Memory_aux_buffer;
+	if (valid == false) {
+		reader.set_error();
 	}
-	if (Memory_aux_bank1_buffer != nullptr) {
-		delete[] Memory_aux_bank1_buffer;
+	if (reader.error()) {
+		return;
+	}
+
+	Memory->m_state = state;
+	Memory->m_expansion_last_access = expansion_last_access;
+	Memory->m_current_expansion_rom_pages = expansion_rom_pages;
+	for (auto i = 0; i < Memory_page_size; i++) {
+		Memory->m_read_pages[i] = list.from_index(read_pages[i]);
+		Memory->m_write_pages[i] = list.from_index(write_pages[i]);
 	}
-	if (Memory_aux_bank2_buffer != nullptr) {
-		delete[] Memory_aux_bank2_buffer;
+	for (uint16_t i = 0; i < Memory_total_pages; i++) {
+		list.from_index(i)->set_write_protected(write_protected[i]);
 	}
-	if (Memory_aux_extended_buffer != nullptr) {
-		delete[] Memory_aux_extended_buffer;
+
+	// memory contents changed underneath the debugger
+	if (Memory->m_opcode_map != nullptr) {
+		memset(Memory->m_opcode_map, 0, Memory_opcode_map_size);
+	}
+	memory_update_fast_pages(0, 0x100);
+}
+
+void memory_shutdown()
+{
+	memory_set_opcode_tracking(false);
+	if (Memory->m_arena != nullptr) {
+		memory_free_arena();
 	}
 }
 
@@ -28,8 +28,12 @@ SOFTWARE.
 #if !defined(MEMORY_H)
 #define MEMORY_H
 
+#include <stddef.h>
 #include <stdint.h>
-#include <functional>
+#include "apple2emu_defs.h"
+
+class snapshot_writer;
+class snapshot_reader;
 
 // defines for memory status (RAM card, 0xc000 usage, etc)
 #define RAM_CARD_READ           (1 << 0)
@@ -54,23 +58,278 @@ enum class memory_high_read_bank : int {
 	READ_BANK2,
 };
 
-extern uint32_t Memory_state;
+// all emulated memory (ram, roms and expansion roms) is in a single
+// arena with a fixed layout (see memory.cpp).  The first
+// Memory_arena_ram_size bytes are all of the ram
+static const uint32_t Memory_arena_size = 0x29000;
+static const uint32_t Memory_arena_ram_size = 0x20000;
+static const uint32_t Memory_arena_alignment = 4096;
+static const uint32_t Memory_huge_page_size = 2 * 1024 * 1024;
+
+// set before memory_init() to back the arena with huge pages (linux only)
+extern bool Memory_use_huge_pages;
+
+// one dirty flag per 256 byte page of the arena.  Each flag has a bit
+// for every consumer of the flags so that they can clear their own bit
+// without losing writes the others haven't seen yet
+static const uint32_t Memory_num_dirty_pages = Memory_arena_size / 256;
+static const uint8_t Memory_dirty_video = (1 << 0);
+static const uint8_t Memory_dirty_snapshot = (1 << 1);
+static const uint8_t Memory_dirty_all = 0xff;
+
+// counters for paging table work.  Counts are for the frame in
+// progress, and memory_end_frame() moves them to the last frame
+struct memory_paging_stats {
+	uint32_t m_updates;   // soft switch changes that rebuilt part of the tables
+	uint32_t m_skipped;   // soft switch changes that didn't affect paging
+	uint32_t m_pages;     // page table entries that were rebuilt
+};
+
+// I/O handlers for the soft switches and slot memory.  These are plain
+// function pointers, called with the context pointer that was passed
+// in when the handler was registered so that a device can get at its
+// own state
+typedef uint8_t (*io_read_function)(void *context, uint16_t addr);
+typedef void (*io_write_function)(void *context, uint16_t addr, uint8_t val);
+
+// a card in one of the peripheral slots.  The io handlers get the 16
+// slot soft switches ($c080 + slot * 16).  memory_write gets writes to
+// the card's $cnxx page (used by the z80 softcard).  Any of the
+// handlers can be nullptr
+struct slot_device {
+	io_read_function   m_io_read;
+	io_write_function  m_io_write;
+	io_write_function  m_memory_write;
+	void              *m_context;
+	uint8_t           *m_expansion_rom;
+};
+
+// values for memory sizes
+static const int Memory_main_size = (48 * 1024);
+static const int Memory_rom_size = (16 * 1024);
+static const int Memory_switched_bank_size = (4 * 1024);
+static const int Memory_c000_rom_size = (4 * 1024);
+static const int Memory_extended_size = (8 * 1024);
+static const int Memory_aux_size = (48 * 1024);
+static const int Memory_expansion_rom_size = (2 * 1024);
+
+static const uint16_t Memory_page_size = 256;
+
+// and page values
+static const int Memory_num_main_pages = (Memory_main_size / Memory_page_size);
+static const int Memory_num_rom_pages = (Memory_rom_size / Memory_page_size);
+static const int Memory_num_bank_pages = (Memory_switched_bank_size / Memory_page_size);
+static const int Memory_num_internal_rom_pages = (Memory_c000_rom_size/ Memory_page_size);
+static const int Memory_num_extended_pages = (Memory_extended_size / Memory_page_size);
+static const int Memory_num_aux_pages = (Memory_aux_size / Memory_page_size);
+static const int Memory_num_expansion_rom_pages (Memory_expansion_rom_size / Memory_page_size);
+
+// information on peripheral slots.  Note that there are really
+// 8 slots in the apple.  1-7 are the normal slots but slot 0
+// was used for the ram card for the apple2/2+
+static const int Num_slots = 8;
+
+// class to handle memory paging.  Simple wrapper class  to hold the
+// pointer and whether or not the page is write protected.  Memory
+// pages will be set up when emulator starts.  Pointers to a full set
+// of 64K will be stored and those pointers will point to memory_page(s)
+// depending on which soft switches have been set
+class memory_page {
+
+private:
+	bool     m_write_protected;
+	uint8_t* m_ptr;
+
+public:
+	memory_page() {};
+
+	// init sets up the pointer to the actually memory and initial
+	// write protect status
+	void init(uint8_t *ptr, bool write_protected) {
+		m_ptr = ptr;
+		m_write_protected = write_protected;
+	}
+
+	// returns write protect status
+	bool const write_protected() const {
+		return m_write_protected;
+	}
+
+	// sets write protect status
+	void set_write_protected(bool write_protected) {
+		m_write_protected = write_protected;
+	}
+
+	// reads the value from the given page address
+	uint8_t read(const uint8_t addr) {
+		return *(m_ptr + addr);
+	}
+
+	// raw pointer to the memory for the fast path
+	uint8_t *ptr() { return m_ptr; }
+
+	// writes out a value
+	void write(const uint16_t addr, uint8_t val) {
+		*(m_ptr + addr) = val;
+	}
+};
+
+// I/O dispatch tables for the $c0xx soft switches.  Reads and writes
+// have their own tables so an access is one table lookup and one call
+struct memory_io_read_handler {
+	io_read_function  m_func;
+	void             *m_context;
+};
+
+struct memory_io_write_handler {
+	io_write_function m_func;
+	void             *m_context;
+};
+
+// everything about the memory of one machine (see machine.h)
+struct memory_state {
+	uint32_t                m_state;   // state of the memory card (RAM_* flags above)
+
+	memory_paging_stats     m_paging_stats;
+	memory_paging_stats     m_paging_stats_last_frame;
+
+	memory_io_read_handler  m_io_read_handlers[256];
+	memory_io_write_handler m_io_write_handlers[256];
+
+	// Need handlers for writing slot memory for some cards
+	memory_io_write_handler m_slot_memory_handlers[Num_slots];
+
+	// main definition of memory pages for the emulator.  There is a
+	// page array for each "type" of memory (i.e. main, rom, extended
+	// auxilliary, etc).
+	memory_page  m_main_pages[Memory_num_main_pages];             // 192 pages - 48k
+	memory_page  m_rom_pages[Memory_num_rom_pages];               // 64 pages - 16k
+	memory_page  m_bank_pages[2][Memory_num_bank_pages];          // 16 pages - 4k
+	memory_page  m_extended_pages[Memory_num_extended_pages];     // 32 pages - 8k
+	memory_page  m_internal_rom_pages[Memory_num_internal_rom_pages]; // 16 page - 4k
+	memory_page  m_aux_pages[Memory_num_aux_pages];               // 16 page - 4k
+	memory_page  m_aux_bank_pages[2][Memory_num_bank_pages];      // 16 pages - 4k
+	memory_page  m_aux_extended_pages[Memory_num_extended_pages]; // 32 pages - 8k
+	memory_page  m_expansion_rom_pages[Num_slots][Memory_num_expansion_rom_pages];  // 8 pages - 2k
+
+	memory_page *m_current_expansion_rom_pages; // this will be what is actively used
+
+	// pointers for read/write pages.  These are the methods by
+	// which memory reading and writing will be done.  We have
+	// separate read/write arrays because the apple allows writing
+	// to RAM banks while allowing reading from ROM area
+	memory_page *m_read_pages[Memory_page_size];
+	memory_page *m_write_pages[Memory_page_size];
+
+	// flat page tables of host pointers for the fast path.  These mirror
+	// the page pointers above and are rebuilt whenever they change.  A
+	// nullptr entry means the page needs the slow path (I/O, slot and
+	// expansion rom handling, write protected pages, and every page
+	// while the debugger is tracking opcodes)
+	uint8_t     *m_read_ptrs[Memory_page_size];
+	uint8_t     *m_write_ptrs[Memory_page_size];
+
+	// count of memory writes and soft switch accesses.  Only differences
+	// matter, it is used to tell what a loop does between two points
+	// (see keyboard_skip_idle_polls())
+	uint32_t     m_access_count;
 
-typedef std::function<uint8_t(uint16_t, uint8_t, bool)> soft_switch_function;
+	// opcode start tracking for the debugger disassembly.  One bit per
+	// 6502 address, only allocated while tracking is on
+	uint8_t     *m_opcode_map;
+
+	// the memory arena (see memory.cpp for the layout) and the dirty
+	// flags for it.  All bits of a flag are set whenever the page is
+	// written.  The video code clears its bit for the pages it displays
+	// once it has redrawn them, and snapshots clear theirs when they
+	// take a copy of the page
+	uint8_t     *m_arena;
+	size_t       m_arena_alloc_size;
+	uint8_t      m_dirty_pages[Memory_num_dirty_pages];
+
+	// the memory buffers.  These all point into the arena, and the
+	// memory_page(s) above point into these
+	uint8_t     *m_buffer;                // main 48k
+	uint8_t     *m_rom_buffer;            // 16k.  c000-cfff is only loaded from the rom on a iie
+	uint8_t     *m_bank1_buffer;          // 4k ram card banks
+	uint8_t     *m_bank2_buffer;
+	uint8_t     *m_extended_buffer;       // 8k extended ram card memory
+	uint8_t     *m_internal_rom_buffer;   // c000-cfff internal rom on the iie
+	uint8_t     *m_aux_buffer;            // the same for aux memory
+	uint8_t     *m_aux_bank1_buffer;
+	uint8_t     *m_aux_bank2_buffer;
+	uint8_t     *m_aux_extended_buffer;
+
+	// nullptr if the card in the slot doesn't have an expansion rom
+	uint8_t     *m_expansion_rom_buffer[Num_slots];
+
+	// a write enable of the ram card takes two accesses in a row
+	uint8_t      m_expansion_last_access;
+};
+
+// memory of the machine running on this thread.  This is kept apart
+// from the machine so that the inline fast path below doesn't need
+// the whole machine definition
+extern THREAD_LOCAL memory_state *Memory;
 
 void memory_init();
 void memory_shutdown();
+uint8_t *memory_get_arena();
 bool memory_load_buffer(uint8_t *buffer, uint16_t size, uint16_t location);
 uint8_t memory_read_main(const uint16_t addr);
 uint8_t memory_read_aux(const uint16_t addr);
-uint8_t memory_read(const uint16_t addr, bool instruction = false);
+const uint8_t *memory_get_read_page(const uint16_t addr);
+const uint8_t *memory_get_main_page(const uint16_t addr);
+const uint8_t *memory_get_aux_page(const uint16_t addr);
+uint8_t memory_read_slow(const uint16_t addr, bool instruction);
 uint8_t memory_read(const uint16_t addr, memory_high_read_type high_type, memory_high_read_bank bank);
 uint8_t memory_read_floating_bus();
 uint16_t memory_find_previous_opcode_addr(const uint16_t addr, int num);
-void memory_write(const uint16_t addr, uint8_t val);
+void memory_set_opcode_tracking(bool on);
+void memory_write_slow(const uint16_t addr, uint8_t val);
 void memory_set_paging_tables();
-void memory_register_slot_handler(const uint8_t slot, soft_switch_function func, uint8_t *expansion_rom = nullptr);
-void memory_register_slot_memory_handler(const uint8_t slot, soft_switch_function func);
+void memory_update_paging_tables(uint32_t old_memory_state, uint8_t old_video_mode);
+void memory_end_frame();
+void memory_register_soft_switch_handler(const uint8_t addr, io_read_function read_func, io_write_function write_func, void *context = nullptr);
+void memory_register_slot_handler(const uint8_t slot, const slot_device &device);
 void memory_init_for_z80_test();
+void memory_save_state(snapshot_writer &writer);
+void memory_load_state(snapshot_reader &reader);
+
+// dirty flag for the arena page that ptr points into
+inline uint8_t &memory_dirty_flag(const uint8_t *ptr)
+{
+	return Memory->m_dirty_pages[(ptr - Memory->m_arena) >> 8];
+}
+
+// read memory.  Ordinary RAM and ROM is a single table lookup, anything
+// else is handled in memory_read_slow()
+inline uint8_t memory_read(const uint16_t addr, bool instruction = false)
+{
+	const uint8_t page = addr >> 8;
+	const uint8_t *ptr = Memory->m_read_ptrs[page];
+	if (ptr == nullptr) {
+		return memory_read_slow(addr, instruction);
+	}
+
+	return ptr[addr & 0xff];
+}
+
+// write memory.  Same as reading, RAM is written directly and everything
+// else goes through memory_write_slow().  Pages in the fast path are
+// always ram, so the page is marked dirty here as well
+inline void memory_write(const uint16_t addr, uint8_t val)
+{
+	const uint8_t page = addr >> 8;
+	uint8_t *ptr = Memory->m_write_ptrs[page];
+	if (ptr == nullptr) {
+		memory_write_slow(addr, val);
+		return;
+	}
+
+	ptr[addr & 0xff] = val;
+	memory_dirty_flag(ptr) = Memory_dirty_all;
+	Memory->m_access_count++;
+}
 
 #endif  // MEMORY_H
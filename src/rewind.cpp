@@ -0,0 +1,254 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <algorithm>
+#include <string.h>
+
+#include "apple2emu_defs.h"
+#include "machine.h"
+#include "rewind.h"
+
+// a keyframe every second
+static const uint32_t Rewind_keyframe_interval = 60;
+
+// run length encoding of the xor of two buffers.  Almost all of it is
+// zero, so a control byte below 0x80 is followed by that many + 1
+// changed bytes, and one of 0x80 or above skips (c & 0x7f) + 1
+// unchanged bytes.  old_data shorter than new_data is padded with zeros
+static void rewind_encode_xor(std::vector<uint8_t> &out, const uint8_t *new_data, size_t new_size, const uint8_t *old_data, size_t old_size)
+{
+	size_t i = 0;
+	while (i < new_size) {
+		size_t start = i;
+		if ((new_data[i] ^ (i < old_size ? old_data[i] : 0)) == 0) {
+			while (i < new_size && i - start < 0x80 && (new_data[i] ^ (i < old_size ? old_data[i] : 0)) == 0) {
+				i++;
+			}
+			out.push_back(static_cast<uint8_t>(0x80 | (i - start - 1)));
+		} else {
+			while (i < new_size && i - start < 0x80 && (new_data[i] ^ (i < old_size ? old_data[i] : 0)) != 0) {
+				i++;
+			}
+			out.push_back(static_cast<uint8_t>(i - start - 1));
+			for (size_t j = start; j < i; j++) {
+				out.push_back(new_data[j] ^ (j < old_size ? old_data[j] : 0));
+			}
+		}
+	}
+}
+
+// applies an encoded xor to data in place.  Returns where the encoded
+// data ends
+static const uint8_t *rewind_decode_xor(const uint8_t *in, uint8_t *data, size_t size)
+{
+	size_t i = 0;
+	while (i < size) {
+		uint8_t c = *in++;
+		size_t count = (c & 0x7f) + 1;
+		SDL_assert(i + count <= size);
+		if ((c & 0x80) == 0) {
+			for (size_t j = 0; j < count; j++) {
+				data[i + j] ^= *in++;
+			}
+		}
+		i += count;
+	}
+	return in;
+}
+
+// the changes that turn last into current: the module state, then the
+// index and contents of every page that isn't shared between them
+static void rewind_encode_frame(std::vector<uint8_t> &out, const machine_snapshot &current, const machine_snapshot &last)
+{
+	out.clear();
+
+	out.push_back(static_cast<uint8_t>(current.m_type));
+	uint32_t state_size = static_cast<uint32_t>(current.m_state.size());
+	out.insert(out.end(), reinterpret_cast<const uint8_t *>(&state_size), reinterpret_cast<const uint8_t *>(&state_size + 1));
+	rewind_encode_xor(out, current.m_state.data(), current.m_state.size(), last.m_state.data(), last.m_state.size());
+
+	for (uint16_t i = 0; i < Snapshot_num_pages; i++) {
+		if (current.m_pages[i] != last.m_pages[i]) {
+			out.insert(out.end(), reinterpret_cast<const uint8_t *>(&i), reinterpret_cast<const uint8_t *>(&i + 1));
+			rewind_encode_xor(out, current.m_pages[i]->m_data, Memory_page_size, last.m_pages[i]->m_data, Memory_page_size);
+		}
+	}
+}
+
+// turns the snapshot of the previous frame into this one
+static void rewind_decode_frame(const std::vector<uint8_t> &delta, machine_snapshot &snapshot)
+{
+	const uint8_t *in = delta.data();
+	const uint8_t *end = in + delta.size();
+
+	snapshot.m_type = static_cast<emulator_type>(*in++);
+	uint32_t state_size;
+	memcpy(&state_size, in, sizeof(state_size));
+	in += sizeof(state_size);
+	snapshot.m_state.resize(state_size, 0);
+	in = rewind_decode_xor(in, snapshot.m_state.data(), state_size);
+
+	while (in < end) {
+		uint16_t index;
+		memcpy(&index, in, sizeof(index));
+		in += sizeof(index);
+		SDL_assert(index < Snapshot_num_pages);
+		std::shared_ptr<snapshot_page> page = std::make_shared<snapshot_page>(*snapshot.m_pages[index]);
+		in = rewind_decode_xor(in, page->m_data, Memory_page_size);
+		snapshot.m_pages[index] = page;
+	}
+}
+
+static void rewind_drop_oldest()
+{
+	rewind_state &rewind = Machine->m_rewind;
+	rewind_frame &frame = rewind.m_frames[rewind.m_first];
+	rewind.m_size -= frame.m_size;
+	frame.m_keyframe.reset();
+	frame.m_size = 0;
+	rewind.m_first = (rewind.m_first + 1) % rewind.m_frames.size();
+	rewind.m_count--;
+}
+
+// keep the given number of seconds of history.  0 turns rewinding off
+void rewind_init(uint32_t seconds)
+{
+	rewind_state &rewind = Machine->m_rewind;
+	rewind.m_frames.clear();
+	rewind.m_frames.shrink_to_fit();
+	rewind.m_frames.resize(seconds * Frames_per_second);
+	rewind_clear();
+}
+
+// forget all history.  Used when the machine changes in a way the
+// history shouldn't go back across
+void rewind_clear()
+{
+	rewind_state &rewind = Machine->m_rewind;
+	for (auto &frame : rewind.m_frames) {
+		frame.m_keyframe.reset();
+		frame.m_size = 0;
+	}
+	rewind.m_first = 0;
+	rewind.m_count = 0;
+	rewind.m_frames_since_keyframe = 0;
+	rewind.m_keyframe_slot = 0;
+	rewind.m_size = 0;
+}
+
+// add the frame that just finished to the history
+void rewind_end_frame()
+{
+	rewind_state &rewind = Machine->m_rewind;
+	if (rewind.m_frames.empty()) {
+		return;
+	}
+
+	if (rewind.m_count == rewind.m_frames.size()) {
+		rewind_drop_oldest();
+	}
+	rewind_frame &frame = rewind.m_frames[(rewind.m_first + rewind.m_count) % rewind.m_frames.size()];
+	rewind.m_count++;
+
+	snapshot_capture(rewind.m_current);
+	if (rewind.m_count == 1 || rewind.m_frames_since_keyframe + 1 >= Rewind_keyframe_interval) {
+		// pages the keyframe doesn't share with the last keyframe are what
+		// it costs.  If that one is gone, count all of them
+		const machine_snapshot *last_keyframe = rewind.m_frames[rewind.m_keyframe_slot].m_keyframe.get();
+		frame.m_size = sizeof(machine_snapshot) + rewind.m_current.m_state.size();
+		for (uint32_t i = 0; i < Snapshot_num_pages; i++) {
+			if (last_keyframe == nullptr || rewind.m_current.m_pages[i] != last_keyframe->m_pages[i]) {
+				frame.m_size += sizeof(snapshot_page);
+			}
+		}
+		frame.m_keyframe = std::make_unique<machine_snapshot>(rewind.m_current);
+		rewind.m_keyframe_slot = static_cast<uint32_t>(&frame - rewind.m_frames.data());
+		rewind.m_frames_since_keyframe = 0;
+	} else {
+		frame.m_keyframe.reset();
+		rewind_encode_frame(frame.m_delta, rewind.m_current, rewind.m_last);
+		frame.m_size = frame.m_delta.size();
+		rewind.m_frames_since_keyframe++;
+	}
+	rewind.m_size += frame.m_size;
+
+	std::swap(rewind.m_last, rewind.m_current);
+}
+
+// frames that can be stepped back to.  Frames older than the oldest
+// keyframe can't be decoded any more
+uint32_t rewind_frames_available()
+{
+	rewind_state &rewind = Machine->m_rewind;
+	for (uint32_t i = 0; i < rewind.m_count; i++) {
+		if (rewind.m_frames[(rewind.m_first + i) % rewind.m_frames.size()].m_keyframe != nullptr) {
+			return rewind.m_count - i - 1;
+		}
+	}
+	return 0;
+}
+
+// go back the given number of frames from the newest one, or as far as
+// the history goes.  Newer frames are thrown away so that running on
+// from here records a new history.  Returns false if there is nothing
+// to go back to
+bool rewind_step_back(uint32_t num_frames)
+{
+	rewind_state &rewind = Machine->m_rewind;
+	uint32_t available = rewind_frames_available();
+	if (available == 0) {
+		return false;
+	}
+	uint32_t target = rewind.m_count - 1 - std::min(num_frames, available);
+
+	// decode forward from the keyframe before the target frame
+	uint32_t keyframe = target;
+	while (rewind.m_frames[(rewind.m_first + keyframe) % rewind.m_frames.size()].m_keyframe == nullptr) {
+		keyframe--;
+	}
+	rewind.m_last = *rewind.m_frames[(rewind.m_first + keyframe) % rewind.m_frames.size()].m_keyframe;
+	for (uint32_t i = keyframe + 1; i <= target; i++) {
+		rewind_decode_frame(rewind.m_frames[(rewind.m_first + i) % rewind.m_frames.size()].m_delta, rewind.m_last);
+	}
+
+	while (rewind.m_count > target + 1) {
+		rewind_frame &frame = rewind.m_frames[(rewind.m_first + rewind.m_count - 1) % rewind.m_frames.size()];
+		rewind.m_size -= frame.m_size;
+		frame.m_keyframe.reset();
+		frame.m_size = 0;
+		rewind.m_count--;
+	}
+	rewind.m_frames_since_keyframe = target - keyframe;
+
+	return snapshot_restore(rewind.m_last);
+}
+
+size_t rewind_get_memory_used()
+{
+	return Machine->m_rewind.m_size;
+}
@@ -0,0 +1,69 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+#include "snapshot.h"
+
+// rewinding.  The state at the end of every frame goes into a ring
+// buffer holding the last few seconds.  Most frames are stored as the
+// changes from the frame before: the ram pages that are different
+// (found through the page sharing of snapshots) and the module state,
+// both xor'ed with the previous frame and run length encoded.  Once a
+// second a full snapshot is kept as a keyframe to start decoding from.
+// Keyframes share unchanged pages with each other and with the machine,
+// so they mostly cost the pages that changed since the last one
+
+// one frame of history
+struct rewind_frame {
+	std::vector<uint8_t>               m_delta;      // changes from the previous frame (unused for keyframes)
+	std::unique_ptr<machine_snapshot>  m_keyframe;   // nullptr unless this is a keyframe
+	size_t                             m_size;       // memory used by the frame
+};
+
+// rewind history of one machine (see machine.h)
+struct rewind_state {
+	std::vector<rewind_frame>  m_frames;                  // ring buffer, empty when rewinding is off
+	uint32_t                   m_first;                   // oldest frame in the ring
+	uint32_t                   m_count;                   // number of frames in the ring
+	uint32_t                   m_frames_since_keyframe;
+	uint32_t                   m_keyframe_slot;           // where the newest keyframe is, if it is still around
+	machine_snapshot           m_last;                    // the newest frame, which the next frame is encoded against
+	machine_snapshot           m_current;
+	size_t                     m_size;                    // memory used by all frames
+};
+
+void rewind_init(uint32_t seconds);
+void rewind_clear();
+void rewind_end_frame();
+bool rewind_step_back(uint32_t num_frames);
+uint32_t rewind_frames_available();
+size_t rewind_get_memory_used();
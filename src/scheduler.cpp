@@ -0,0 +1,102 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <algorithm>
+#include <vector>
+
+#include "apple2emu_defs.h"
+#include "scheduler.h"
+
+THREAD_LOCAL scheduler_state *Scheduler = nullptr;
+
+static bool scheduler_event_later(const scheduler_event &a, const scheduler_event &b)
+{
+	return a.m_cycle > b.m_cycle;
+}
+
+static void scheduler_update_next_event()
+{
+	Scheduler->m_next_event_cycle = Scheduler->m_events.empty() ? UINT64_MAX : Scheduler->m_events.front().m_cycle;
+}
+
+// remove all pending events.  Called on machine reset before the
+// peripherals get initialized (and register their events again)
+void scheduler_init()
+{
+	Scheduler->m_events.clear();
+	scheduler_update_next_event();
+}
+
+void scheduler_add_event(uint64_t cycle, scheduler_callback callback, void *context)
+{
+	SDL_assert(callback != nullptr);
+	Scheduler->m_events.push_back({ cycle, callback, context });
+	std::push_heap(Scheduler->m_events.begin(), Scheduler->m_events.end(), scheduler_event_later);
+	scheduler_update_next_event();
+}
+
+// remove any pending events for the given callback and context.  There
+// are only ever a handful of events pending so just rebuild the heap
+void scheduler_remove_event(scheduler_callback callback, void *context)
+{
+	auto it = std::remove_if(Scheduler->m_events.begin(), Scheduler->m_events.end(),
+		[callback, context](const scheduler_event &e) { return e.m_callback == callback && e.m_context == context; });
+	if (it == Scheduler->m_events.end()) {
+		return;
+	}
+	Scheduler->m_events.erase(it, Scheduler->m_events.end());
+	std::make_heap(Scheduler->m_events.begin(), Scheduler->m_events.end(), scheduler_event_later);
+	scheduler_update_next_event();
+}
+
+// find the pending event for the given callback and context.  Used by
+// save states to write out when an event is due
+bool scheduler_find_event(scheduler_callback callback, void *context, uint64_t &cycle)
+{
+	for (const auto &e : Scheduler->m_events) {
+		if (e.m_callback == callback && e.m_context == context) {
+			cycle = e.m_cycle;
+			return true;
+		}
+	}
+	return false;
+}
+
+// run all events that are due at the given cycle count.  Callbacks are
+// free to add new events (including re-adding themselves)
+void scheduler_dispatch(uint64_t cycle)
+{
+	while (Scheduler->m_events.empty() == false && Scheduler->m_events.front().m_cycle <= cycle) {
+		std::pop_heap(Scheduler->m_events.begin(), Scheduler->m_events.end(), scheduler_event_later);
+		scheduler_event e = Scheduler->m_events.back();
+		Scheduler->m_events.pop_back();
+		scheduler_update_next_event();
+		e.m_callback(e.m_context, e.m_cycle);
+	}
+	scheduler_update_next_event();
+}
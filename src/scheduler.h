@@ -0,0 +1,68 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "apple2emu_defs.h"
+
+// event scheduler.  Peripherals register callbacks to be run when the
+// machine's cycle clock (m_total_cycles) reaches a given count, so the
+// cpu loop only has to compare against the next event time instead of
+// polling every peripheral after each opcode.
+typedef void (*scheduler_callback)(void *context, uint64_t cycle);
+
+struct scheduler_event {
+	uint64_t            m_cycle;
+	scheduler_callback  m_callback;
+	void               *m_context;
+};
+
+// pending events for one machine (see machine.h)
+struct scheduler_state {
+	std::vector<scheduler_event> m_events;             // min heap of pending events ordered on cycle count
+	uint64_t                     m_next_event_cycle;   // cycle count of the earliest pending event
+};
+
+// events of the machine running on this thread
+extern THREAD_LOCAL scheduler_state *Scheduler;
+
+void scheduler_init();
+void scheduler_add_event(uint64_t cycle, scheduler_callback callback, void *context);
+void scheduler_remove_event(scheduler_callback callback, void *context);
+bool scheduler_find_event(scheduler_callback callback, void *context, uint64_t &cycle);
+void scheduler_dispatch(uint64_t cycle);
+
+// run any events that are due at the given cycle count
+inline void scheduler_process(uint64_t cycle)
+{
+	if (cycle >= Scheduler->m_next_event_cycle) {
+		scheduler_dispatch(cycle);
+	}
+}
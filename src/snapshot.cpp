@@ -0,0 +1,205 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "apple2emu_defs.h"
+#include "machine.h"
+#include "snapshot.h"
+
+// file header for saved states
+static const uint32_t Snapshot_file_magic = 'A2SS';
+
+// the module state is a few kilobytes.  Anything much bigger is a
+// damaged file
+static const uint32_t Snapshot_max_state_size = 1024 * 1024;
+
+// take a snapshot of the current machine.  Only ram pages written since
+// the last snapshot are copied, the rest are shared with it
+void snapshot_capture(machine_snapshot &snapshot)
+{
+	snapshot_state &state = Machine->m_snapshot;
+	for (uint32_t i = 0; i < Snapshot_num_pages; i++) {
+		uint8_t &dirty = Memory->m_dirty_pages[i];
+		if ((dirty & Memory_dirty_snapshot) || state.m_pages[i] == nullptr) {
+			std::shared_ptr<snapshot_page> page = std::make_shared<snapshot_page>();
+			memcpy(page->m_data, &Memory->m_arena[i * Memory_page_size], Memory_page_size);
+			state.m_pages[i] = page;
+			dirty &= ~Memory_dirty_snapshot;
+		}
+		snapshot.m_pages[i] = state.m_pages[i];
+	}
+
+	snapshot.m_type = Machine->m_type;
+	snapshot.m_version = Snapshot_version;
+	snapshot.m_state.clear();
+	snapshot.m_state.reserve(state.m_state_size);
+
+	// everything else.  snapshot_restore() reads this back in the same order
+	snapshot_writer writer(snapshot.m_state);
+	writer.write(Machine->m_total_cycles);
+	writer.write(Machine->m_total_cycles_this_frame);
+	Machine->m_cpu.save_state(writer);
+	memory_save_state(writer);
+	video_save_state(writer);
+	disk_save_state(writer);
+	keyboard_save_state(writer);
+	speaker_save_state(writer);
+	joystick_save_state(writer);
+	z80softcard_save_state(writer);
+	state.m_state_size = snapshot.m_state.size();
+}
+
+// put the current machine back to the state in the snapshot.  The
+// machine is reset first if the snapshot is of a different type so that
+// the right roms are loaded.  Returns false if the snapshot is damaged,
+// in which case the machine should be reset
+bool snapshot_restore(const machine_snapshot &snapshot)
+{
+	if (snapshot.m_version > Snapshot_version) {
+		printf("Save state version %u is newer than this emulator supports\n", snapshot.m_version);
+		return false;
+	}
+	for (uint32_t i = 0; i < Snapshot_num_pages; i++) {
+		if (snapshot.m_pages[i] == nullptr) {
+			printf("Save state is missing memory\n");
+			return false;
+		}
+	}
+
+	if (snapshot.m_type != Machine->m_type) {
+		Machine->m_type = snapshot.m_type;
+		machine_reset();
+	}
+
+	// the modules add back the events they had pending
+	scheduler_init();
+
+	// the machine now shares every page with the snapshot.  The video
+	// bit is set since the screen memory changed underneath it
+	snapshot_state &state = Machine->m_snapshot;
+	for (uint32_t i = 0; i < Snapshot_num_pages; i++) {
+		if (state.m_pages[i] != snapshot.m_pages[i] || (Memory->m_dirty_pages[i] & Memory_dirty_snapshot)) {
+			memcpy(&Memory->m_arena[i * Memory_page_size], snapshot.m_pages[i]->m_data, Memory_page_size);
+			state.m_pages[i] = snapshot.m_pages[i];
+			Memory->m_dirty_pages[i] |= Memory_dirty_video;
+		}
+		Memory->m_dirty_pages[i] &= ~Memory_dirty_snapshot;
+	}
+
+	snapshot_reader reader(snapshot.m_state, snapshot.m_version);
+	reader.read(Machine->m_total_cycles);
+	reader.read(Machine->m_total_cycles_this_frame);
+	Machine->m_cpu.load_state(reader);
+	memory_load_state(reader);
+	video_load_state(reader);
+	disk_load_state(reader);
+	keyboard_load_state(reader);
+	speaker_load_state(reader);
+	joystick_load_state(reader);
+	z80softcard_load_state(reader);
+
+	if (reader.error()) {
+		printf("Save state is damaged\n");
+		return false;
+	}
+	return true;
+}
+
+// write a snapshot out to a file.  The file is the header, the module
+// state and then all of the ram pages, in host byte order
+bool snapshot_save(const machine_snapshot &snapshot, const char *filename)
+{
+	FILE *fp = fopen(filename, "wb");
+	if (fp == nullptr) {
+		printf("Unable to open %s for writing\n", filename);
+		return false;
+	}
+
+	uint32_t header[5] = {
+		Snapshot_file_magic,
+		snapshot.m_version,
+		static_cast<uint32_t>(snapshot.m_type),
+		static_cast<uint32_t>(snapshot.m_state.size()),
+		Snapshot_num_pages,
+	};
+	bool ok = fwrite(header, sizeof(header), 1, fp) == 1;
+	if (ok && snapshot.m_state.empty() == false) {
+		ok = fwrite(snapshot.m_state.data(), snapshot.m_state.size(), 1, fp) == 1;
+	}
+	for (uint32_t i = 0; ok && i < Snapshot_num_pages; i++) {
+		ok = fwrite(snapshot.m_pages[i]->m_data, Memory_page_size, 1, fp) == 1;
+	}
+	if (fclose(fp) != 0) {
+		ok = false;
+	}
+
+	if (ok == false) {
+		printf("Unable to write save state to %s\n", filename);
+	}
+	return ok;
+}
+
+bool snapshot_load(machine_snapshot &snapshot, const char *filename)
+{
+	FILE *fp = fopen(filename, "rb");
+	if (fp == nullptr) {
+		printf("Unable to open save state %s\n", filename);
+		return false;
+	}
+
+	uint32_t header[5];
+	bool ok = fread(header, sizeof(header), 1, fp) == 1 && header[0] == Snapshot_file_magic;
+	if (ok && (header[1] > Snapshot_version || header[2] >= static_cast<uint32_t>(emulator_type::NUM_EMULATOR_TYPES) ||
+		header[3] > Snapshot_max_state_size || header[4] != Snapshot_num_pages)) {
+		printf("Save state %s is from an unsupported version\n", filename);
+		fclose(fp);
+		return false;
+	}
+
+	if (ok) {
+		snapshot.m_version = header[1];
+		snapshot.m_type = static_cast<emulator_type>(header[2]);
+		snapshot.m_state.resize(header[3]);
+		if (header[3] != 0) {
+			ok = fread(snapshot.m_state.data(), header[3], 1, fp) == 1;
+		}
+	}
+	for (uint32_t i = 0; ok && i < Snapshot_num_pages; i++) {
+		std::shared_ptr<snapshot_page> page = std::make_shared<snapshot_page>();
+		ok = fread(page->m_data, Memory_page_size, 1, fp) == 1;
+		snapshot.m_pages[i] = page;
+	}
+	fclose(fp);
+
+	if (ok == false) {
+		printf("%s is not a valid save state\n", filename);
+	}
+	return ok;
+}
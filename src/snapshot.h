@@ -0,0 +1,129 @@
+/*
+
+MIT License
+
+Copyright (c) 2016-2017 Mark Allender
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+#include "apple2emu.h"
+#include "memory.h"
+
+// save states.  A snapshot holds the ram of a machine as 256 byte pages
+// plus a small block with everything else (registers, soft switches,
+// drive state, ...) that the modules write out themselves.  Pages that
+// haven't been written since the last snapshot of the same machine are
+// shared with it instead of copied, using the memory dirty flags, so
+// taking a snapshot is mostly a matter of bumping reference counts.
+
+static const uint32_t Snapshot_num_pages = Memory_arena_ram_size / Memory_page_size;
+
+// current version of the module state block and the file format.  Bump
+// this when anything is added, and check m_version when reading to keep
+// older files loading
+static const uint32_t Snapshot_version = 1;
+
+struct snapshot_page {
+	uint8_t m_data[Memory_page_size];
+};
+
+struct machine_snapshot {
+	emulator_type                         m_type;
+	uint32_t                              m_version;
+	std::vector<uint8_t>                  m_state;                      // module state, see snapshot_writer
+	std::shared_ptr<const snapshot_page>  m_pages[Snapshot_num_pages];  // ram, in arena order
+};
+
+// the pages of the last snapshot taken of (or restored into) a machine.
+// A page is still current as long as its snapshot dirty flag is clear
+struct snapshot_state {
+	std::shared_ptr<const snapshot_page>  m_pages[Snapshot_num_pages];
+	size_t                                m_state_size;   // size of the last module state, to size the next one up front
+};
+
+// modules append their state to the snapshot with this.  Values are
+// stored in host byte order
+class snapshot_writer {
+private:
+	std::vector<uint8_t> &m_data;
+
+public:
+	snapshot_writer(std::vector<uint8_t> &data) : m_data(data) {}
+
+	void write_bytes(const void *src, size_t size) {
+		const uint8_t *bytes = static_cast<const uint8_t *>(src);
+		m_data.insert(m_data.end(), bytes, bytes + size);
+	}
+
+	template <typename T> void write(const T &val) {
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written to a snapshot");
+		write_bytes(&val, sizeof(T));
+	}
+};
+
+// and read it back in the same order.  Reading past the end of the
+// state sets the error flag and returns zeroes
+class snapshot_reader {
+private:
+	const std::vector<uint8_t> &m_data;
+	size_t                      m_pos;
+	bool                        m_error;
+
+public:
+	uint32_t                    m_version;   // version the snapshot was written with
+
+	snapshot_reader(const std::vector<uint8_t> &data, uint32_t version) : m_data(data), m_pos(0), m_error(false), m_version(version) {}
+
+	void read_bytes(void *dest, size_t size) {
+		if (size == 0) {
+			return;
+		}
+		if (m_error || m_pos + size > m_data.size()) {
+			m_error = true;
+			memset(dest, 0, size);
+			return;
+		}
+		memcpy(dest, &m_data[m_pos], size);
+		m_pos += size;
+	}
+
+	template <typename T> void read(T &val) {
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read from a snapshot");
+		read_bytes(&val, sizeof(T));
+	}
+
+	// for values that were read fine but make no sense
+	void set_error() { m_error = true; }
+	bool error() const { return m_error; }
+};
+
+void snapshot_capture(machine_snapshot &snapshot);
+bool snapshot_restore(const machine_snapshot &snapshot);
+bool snapshot_save(const machine_snapshot &snapshot, const char *filename);
+bool snapshot_load(machine_snapshot &snapshot, const char *filename);
@@ -30,21 +30,16 @@ SOFTWARE.
 #include "SDL.h"
 #include "apple2emu.h"
 #include "apple2emu_defs.h"
+#include "machine.h"
 #include "speaker.h"
 #include "memory.h"
+#include "snapshot.h"
 
-static SDL_AudioDeviceID Device_id = 0;
-static SDL_AudioSpec Audio_spec;
+THREAD_LOCAL speaker_state *Speaker = nullptr;
 
 const static int Sound_samples = 22050;
 const static int Sound_num_channels = 1;
 
-// buffer size set to 512, which, while hard coded
-// is chosen because SDL requires a power ot 2 for
-// the sound buffer and we can make sure that
-// we still this buffer at the correcct rate
-const static int Sound_buffer_size = 512;
-
 // Speaker_sample_cycle_count tells us how often we need to fill
 // buffer (in ms).  Cycles_per_frame is number of cycles per
 // millisecond (roughly).  Sound_samples / 60 is how often we need to fill
@@ -53,52 +48,79 @@ const static int Sound_buffer_size = 512;
 // we must fill the sound buffer in apple cycle counts
 const int Speaker_sample_cycle_count = Cycles_per_frame / (Sound_samples / Frames_per_second);
 
-static int8_t Sound_silence;
+const static int8_t Sound_silence = SCHAR_MIN;
 static float Sound_volume = 0.5;
 
-// ring bugger
-const static int Sound_ring_buffer_size = Sound_buffer_size * 3;
-static int8_t Sound_ring_buffer[Sound_ring_buffer_size];
-uint32_t Tail_index, Head_index;
-
-static bool Speaker_on = false;
-static int Speaker_cycles = 0;
-
+// called from the SDL audio thread, so the speaker state comes in
+// through userdata rather than from the current machine
 static void speaker_callback(void *userdata, uint8_t *stream, int len)
 {
-	UNREFERENCED(userdata);
+	speaker_state *speaker = static_cast<speaker_state *>(userdata);
 	int index = 0;
-	while (Head_index < Tail_index) {
-		stream[index] = uint8_t(Sound_ring_buffer[(Head_index++) % Sound_ring_buffer_size] * Sound_volume);
+	while (speaker->m_head_index < speaker->m_tail_index) {
+		stream[index] = uint8_t(speaker->m_ring_buffer[(speaker->m_head_index++) % Sound_ring_buffer_size] * Sound_volume);
 		index++;
 		if (index == len) {
 			break;
 		}
 	}
-	uint8_t val = stream[index-1];
+	// with nothing queued, play what the idle speaker would
+	uint8_t val = index > 0 ? stream[index - 1] : uint8_t(Sound_silence * Sound_volume);
 	while (index < len) {
 		// stream[index++] = Sound_silence;
 		stream[index++] = val;
 	}
 }
 
-uint8_t speaker_soft_switch_handler(uint16_t addr, uint8_t val, bool write)
+static void speaker_toggle()
 {
-	Speaker_on = !Speaker_on;
-	UNREFERENCED(addr);
-	UNREFERENCED(val);
-	UNREFERENCED(write);
+	// get samples written up to now with the current state before
+	// flipping the speaker
+	speaker_update();
+	Speaker->m_on = !Speaker->m_on;
+}
 
+uint8_t speaker_soft_switch_read(void *context, uint16_t addr)
+{
+	UNREFERENCED(context);
+	UNREFERENCED(addr);
+	speaker_toggle();
 	return memory_read_floating_bus();
 }
 
+void speaker_soft_switch_write(void *context, uint16_t addr, uint8_t val)
+{
+	UNREFERENCED(context);
+	UNREFERENCED(addr);
+	UNREFERENCED(val);
+	speaker_toggle();
+}
+
 // initialize the speaker system.  For now, this is just setting up a handler
 // for the memory location that will do nothing
 void speaker_init()
 {
 	// allow for re-entrancy
-	if (Device_id != 0) {
-		SDL_CloseAudioDevice(Device_id);
+	if (Speaker->m_device_id != 0) {
+		SDL_CloseAudioDevice(Speaker->m_device_id);
+	}
+
+	Speaker->m_device_id = 0;
+
+	// set up sound buffer
+	Speaker->m_sample_cycle = Machine->m_total_cycles;
+
+	Speaker->m_tail_index = Speaker->m_head_index = 0;
+	for (auto i = 0; i < Sound_ring_buffer_size; i++) {
+		Speaker->m_ring_buffer[i] = 0;
+	}
+	Speaker->m_on = false;
+	Speaker->m_cycles_per_sample = Speaker_sample_cycle_count;
+	Speaker->m_muted = false;
+
+	// no audio when running headless
+	if (SDL_WasInit(SDL_INIT_AUDIO) == 0) {
+		return;
 	}
 
 	// open up sdl audio device to write wave data
@@ -109,80 +131,130 @@ void speaker_init()
 	want.freq = Sound_samples;
 	want.samples = Sound_buffer_size;
 	want.callback = speaker_callback;
+	want.userdata = Speaker;
 	// want.callback = nullptr;
 
-	Device_id = SDL_OpenAudioDevice(nullptr, 0, &want, &Audio_spec, 0);
-	if (Device_id == 0) {
+	SDL_AudioSpec have;
+	Speaker->m_device_id = SDL_OpenAudioDevice(nullptr, 0, &want, &have, 0);
+	if (Speaker->m_device_id == 0) {
 		printf("Unable to get valid SDL Audio device: %s\n", SDL_GetError());
 		return;
 	}
 
-	SDL_PauseAudioDevice(Device_id, 1);
-
-	// set up sound buffer
-	Speaker_cycles = 0;
-
-	Tail_index = Head_index = 0;
-	for (auto i = 0; i < Sound_ring_buffer_size; i++) {
-		Sound_ring_buffer[i] = 0;
-	}
-	Speaker_on = false;
-
-	Sound_silence = SCHAR_MIN;
+	SDL_PauseAudioDevice(Speaker->m_device_id, 1);
 }
 
 void speaker_shutdown()
 {
-	if (Device_id != 0) {
-		SDL_CloseAudioDevice(Device_id);
+	if (Speaker->m_device_id != 0) {
+		SDL_CloseAudioDevice(Speaker->m_device_id);
+		Speaker->m_device_id = 0;
 	}
 }
 
-// update internal speaker code, which will first entail
-// writing out information on current speaker status to
-// the buffer, and then, if full, copying the buffer to
-// the SDL audio queue
-void speaker_update(int cycles)
+// update internal speaker code, which writes out samples for the
+// speaker status for all of the cycles that have elapsed since the
+// last update.  Called when the speaker toggles and at the end of each
+// timeslice rather than after every opcode
+void speaker_update()
 {
-	Speaker_cycles += cycles;
-	if (Speaker_cycles < Speaker_sample_cycle_count) {
+	uint32_t num_samples = uint32_t((Machine->m_total_cycles - Speaker->m_sample_cycle) / Speaker->m_cycles_per_sample);
+	if (num_samples == 0) {
+		return;
+	}
+	Speaker->m_sample_cycle += uint64_t(num_samples) * Speaker->m_cycles_per_sample;
+
+	// nothing is draining the ring buffer without an audio device
+	if (Speaker->m_device_id == 0 || Speaker->m_muted) {
 		return;
 	}
-	Speaker_cycles -= Speaker_sample_cycle_count;
 
 	// assume speaker on
 	int8_t val = Sound_silence;
-	if (Speaker_on) {
+	if (Speaker->m_on) {
 		val = ~val;
 	}
 
 	// ring buffer
-	SDL_LockAudioDevice(Device_id);
-	Sound_ring_buffer[(Tail_index++) % Sound_ring_buffer_size] = val;
-	SDL_assert(Tail_index - Head_index < Sound_ring_buffer_size);
-	SDL_UnlockAudioDevice(Device_id);
+	SDL_LockAudioDevice(Speaker->m_device_id);
+	for (uint32_t i = 0; i < num_samples; i++) {
+		Speaker->m_ring_buffer[(Speaker->m_tail_index++) % Sound_ring_buffer_size] = val;
+	}
+	SDL_assert(Speaker->m_tail_index - Speaker->m_head_index < Sound_ring_buffer_size);
+	SDL_UnlockAudioDevice(Speaker->m_device_id);
 
 	// fill the buffer if we have reached that point
-	// if (Tail_index - Head_index >= Sound_buffer_size) {
+	// if (Speaker->m_tail_index - Speaker->m_head_index >= Sound_buffer_size) {
 	// 	uint8_t buffer[Sound_buffer_size];
 
 	// 	auto index = 0;
-	// 	while (Head_index < Tail_index && index < Sound_buffer_size) {
+	// 	while (Speaker->m_head_index < Speaker->m_tail_index && index < Sound_buffer_size) {
 	// 		SDL_assert(index< Sound_buffer_size);
-	// 		buffer[index++] = uint8_t(Sound_ring_buffer[(Head_index++) % Sound_ring_buffer_size] * Sound_volume);
+	// 		buffer[index++] = uint8_t(Speaker->m_ring_buffer[(Speaker->m_head_index++) % Sound_ring_buffer_size] * Sound_volume);
 	// 	}
-	// 	SDL_QueueAudio(Device_id, buffer, Sound_buffer_size);
+	// 	SDL_QueueAudio(Speaker->m_device_id, buffer, Sound_buffer_size);
 	// }
 }
 
 void speaker_pause()
 {
-	SDL_PauseAudioDevice(Device_id, 1);
+	SDL_PauseAudioDevice(Speaker->m_device_id, 1);
 }
 
+// stays paused while muted since nothing is queued for the device
 void speaker_unpause()
 {
-	SDL_PauseAudioDevice(Device_id, 0);
+	if (Speaker->m_muted) {
+		return;
+	}
+	SDL_PauseAudioDevice(Speaker->m_device_id, 0);
+}
+
+// the audio device always plays at the same rate, so when the machine
+// runs faster or slower than a real one the samples are taken that much
+// further apart (or closer together).  This keeps the ring buffer from
+// over or under running at the cost of shifting the pitch
+void speaker_set_speed(float speed)
+{
+	SDL_assert(speed > 0.0f);
+	uint32_t cycles = uint32_t(Speaker_sample_cycle_count * speed + 0.5f);
+	if (cycles == 0) {
+		cycles = 1;
+	}
+	if (cycles != Speaker->m_cycles_per_sample) {
+		// write out what is owed at the old rate first
+		speaker_update();
+		Speaker->m_cycles_per_sample = cycles;
+	}
+}
+
+// muted while warping since nothing could drain the samples fast enough
+void speaker_set_muted(bool muted)
+{
+	Speaker->m_muted = muted;
+	if (muted) {
+		speaker_pause();
+	}
+}
+
+void speaker_save_state(snapshot_writer &writer)
+{
+	writer.write(Speaker->m_on);
+	writer.write(Speaker->m_sample_cycle);
+}
+
+// samples already in the ring buffer are left to play out
+void speaker_load_state(snapshot_reader &reader)
+{
+	reader.read(Speaker->m_on);
+	reader.read(Speaker->m_sample_cycle);
+
+	// older states saved headless never wrote out the samples they owed,
+	// far more than the ring buffer holds, so sampling picks up from the
+	// restored clock for those
+	if (Machine->m_total_cycles - Speaker->m_sample_cycle > Cycles_per_frame) {
+		Speaker->m_sample_cycle = Machine->m_total_cycles;
+	}
 }
 
 void speaker_set_volume(int volume)
@@ -28,12 +28,44 @@ SOFTWARE.
 #pragma once
 
 #include <stdint.h>
+#include "SDL.h"
+#include "apple2emu_defs.h"
+
+class snapshot_writer;
+class snapshot_reader;
+
+// buffer size set to 512, which, while hard coded
+// is chosen because SDL requires a power ot 2 for
+// the sound buffer and we can make sure that
+// we still this buffer at the correcct rate
+const static int Sound_buffer_size = 512;
+const static int Sound_ring_buffer_size = Sound_buffer_size * 3;
+
+// speaker of one machine (see machine.h).  Samples are written to the
+// ring buffer as the machine runs and drained by the audio device
+struct speaker_state {
+	SDL_AudioDeviceID m_device_id;
+	int8_t            m_ring_buffer[Sound_ring_buffer_size];
+	uint32_t          m_tail_index, m_head_index;
+	bool              m_on;
+	uint64_t          m_sample_cycle;   // cycle count up to which samples have been written to the ring buffer
+	uint32_t          m_cycles_per_sample;
+	bool              m_muted;
+};
+
+// speaker of the machine running on this thread
+extern THREAD_LOCAL speaker_state *Speaker;
 
 void speaker_init();
 void speaker_shutdown();
-uint8_t speaker_soft_switch_handler(uint16_t addr, uint8_t val, bool write);
-void speaker_update(int cycles);
+uint8_t speaker_soft_switch_read(void *context, uint16_t addr);
+void speaker_soft_switch_write(void *context, uint16_t addr, uint8_t val);
+void speaker_update();
 void speaker_pause();
 void speaker_unpause();
+void speaker_set_speed(float speed);
+void speaker_set_muted(bool muted);
+void speaker_save_state(snapshot_writer &writer);
+void speaker_load_state(snapshot_reader &reader);
 
 void speaker_set_volume(int volume);
\ No newline at end of file
@@ -25,9 +25,14 @@ SOFTWARE.
 
 */
 
+#include <mutex>
+
 #include "apple2emu_defs.h"
 #include "apple2emu.h"
+#include "machine.h"
 #include "memory.h"
+#include "scheduler.h"
+#include "snapshot.h"
 #include "video.h"
 #include "font.h"
 #include "interface.h"
@@ -38,43 +43,84 @@ static const int Num_vertical_cells = 24;
 static const int Num_vertical_cells_mixed = 20;
 static const int Num_horizontal_cells = 40;
 
-// always render to default size - SDL can scale it up
-// we use 560 here because of double hires (and 80 column
-// support.
-const int Video_native_width = 560;
-const int Video_native_height = 384;
 const int Video_cell_width = Video_native_width / 40;
 const int Video_cell_height = Video_native_height / 24;
 
-// information about internally built textures
+THREAD_LOCAL video_state *Video = nullptr;
+
+static const int Num_video_lines_mixed = 160;
+static const int Num_text_font_rows = 16;
+static const int Text_char_width = 14;
+static const int Text80_char_width = 7;
+
+// information about internally built lookup tables
 static const int Num_lores_colors = 16;
 static const int Num_hires_mono_patterns = 128;
 static const int Num_hires_color_patterns = 256;
-static const int Hires_texture_width = 8;
+static const int Hires_pixels_per_byte = 14;
+static const int Double_pixels_per_byte = 7;
+static const int Hires_pattern_stride = 16;
 static const int Num_hires_pattern_variations = 4;
-static const int Hires_color_texture_width = Hires_texture_width * Num_hires_pattern_variations * 2;  // mult by 2 for odd/even
-
-// textures and pixel storage for mono mode.  There
-// are only 128 patterns since we don't need to worry
-// about the color bit (high bit)
-static GLuint Hires_mono_textures[Num_hires_mono_patterns];
-static uint8_t *Hires_mono_pixels[Num_hires_mono_patterns];
-
-// textures and pixel patterns for color mode. there are
-// 256 * 3 patterns for color because we have patterns
-// that follow the regular pattern.  A complete set
-// with left most bit set to white for when this is adjacent
-// to another pixel and a set with the right bit as white
-// when it is adjacent to another pixel
-static GLuint Hires_color_texture;
-static uint8_t *Hires_color_pixels;
-
-SDL_TimerID Video_flash_timer;
-bool Video_flash = false;
+static const int Num_font_chars = 128;
+
+static const uint32_t Video_black = 0xff000000;
+static const uint32_t Video_white = 0xffffffff;
+
+// pixels for mono mode.  There are only 128 patterns since
+// we don't need to worry about the color bit (high bit).  Each
+// of the 7 dots is 2 pixels wide.  Patterns are padded out to 16
+// pixels so that each one is exactly one cache line
+alignas(64) static uint32_t Hires_mono_pixels[Num_hires_mono_patterns][Hires_pattern_stride];
+
+// pixel patterns for color mode. The color of a dot depends on
+// its neighbors, so there are 4 variations of each of the 256 patterns
+// for the neighboring dots of the bytes to the left and right.  And
+// each of those has a version for even and odd byte columns.  Padded
+// the same as the mono patterns, which matters more here since the
+// table is much bigger than the L1 cache
+alignas(64) static uint32_t Hires_color_pixels[Num_hires_color_patterns][2][Num_hires_pattern_variations][Hires_pattern_stride];
+
+// lores colors as framebuffer pixels
+static uint32_t Lores_pixels[Num_lores_colors];
+
+// double hires colors.  Every 4 dots across the line make one of the
+// lores colors, indexed here by the 4 dots (leftmost in the low bit)
+static uint32_t Double_hires_pixels[Num_lores_colors];
+
+// double lores pixels for one column, indexed by the aux color in the
+// high nibble and the main color in the low nibble.  Padded like the
+// hires patterns
+alignas(64) static uint32_t Double_lores_pixels[Num_lores_colors * Num_lores_colors][Hires_pattern_stride];
+
+// text characters.  One bit per dot for each row of each character,
+// built from the font bitmaps.  Fonts are normal and inverse for
+// 40 and 80 column text
+enum video_text_font {
+	TEXT_FONT_NORMAL = 0,
+	TEXT_FONT_INVERSE,
+	TEXT_FONT_80_NORMAL,
+	TEXT_FONT_80_INVERSE,
+	NUM_TEXT_FONTS,
+};
+static uint16_t Video_text_glyphs[NUM_TEXT_FONTS][Num_font_chars][Num_text_font_rows];
+
+// 7 dots to 7 pixels, used to expand text glyph rows
+static uint32_t Video_dot_pixels[128][7];
+
+// a beam pass is one Cycles_per_frame period of the cycle counter.
+// Each line is 65 cycles, the first 25 of which are horizontal
+// blanking, and lines 192-261 are vertical blanking
+static const uint32_t Video_hblank_cycles = 25;
+
+// flashing characters toggle every 250ms of emulated time
+const uint64_t Video_flash_cycles = uint64_t(FREQ_6502 / 4);
+
+// the fonts and all of the lookup tables never change once they are
+// built, so they are built once and shared by all machines
 font Video_font, Video_inverse_font;
 font Video_font_80, Video_inverse_font_80;
-
-uint8_t Video_mode = VIDEO_MODE_TEXT;
+static std::once_flag Video_tables_built;
+static bool Video_tables_valid = false;
 
 uint16_t       Video_primary_text_map[Num_vertical_cells];
 uint16_t       Video_secondary_text_map[Num_vertical_cells];
@@ -89,13 +135,11 @@ static GLfloat Video_tint_colors[static_cast<uint8_t>(video_tint_types::NUM_TINT
 	{ 1.0f, 1.0f, 1.0f },
 };
 
-static GLfloat *Video_tint_color = Video_tint_colors[0];
-static video_tint_types Video_tint_type = video_tint_types::MONO_WHITE;
 
 // values for lores colors
 // see http://mrob.com/pub/xapple2/colors.html
 // for values.  Good enough for a start
-static GLubyte Lores_colors[Num_lores_colors][3] =
+static const uint8_t Lores_colors[Num_lores_colors][3] =
 {
 	{ 0x00, 0x00, 0x00 },                 // black
 	{ 0xe3, 0x1e, 0x60 },                 // red
@@ -118,7 +162,7 @@ static GLubyte Lores_colors[Num_lores_colors][3] =
 // commented out colors from http://mrob.com/pub/xapple2/colors.html
 //
 // current colors from AppleWin.  Using their colors as they look better I think
-static GLubyte Hires_colors[4][3] = {
+static const uint8_t Hires_colors[4][3] = {
 	//{ 255, 68, 253 },     // violet
 	//{ 20, 245, 60 },      // green
 	//{ 20, 207, 253 },     // blue
@@ -207,44 +251,28 @@ static char character_conv_2e[] = {
 	'x', 'y', 'z', '{', '|', '}', '~', 0x7f,    /* $F8	*/
 };
 
-// callback for flashing characters
-static uint32_t timer_flash_callback(uint32_t interval, void *param)
+// scheduler callback for flashing characters
+static void video_flash_callback(void *context, uint64_t cycle)
+{
+	UNREFERENCED(context);
+	Video->m_flash = !Video->m_flash;
+	scheduler_add_event(cycle + Video_flash_cycles, video_flash_callback, nullptr);
+}
+
+// pack a color into a framebuffer pixel
+static uint32_t video_pack_color(const uint8_t *color)
 {
-	UNREFERENCED(param);
-	Video_flash = !Video_flash;
-	return interval;
+	return 0xff000000 | (color[2] << 16) | (color[1] << 8) | color[0];
 }
 
-// create internal texture which will be used for blitting hires pixel
-// patterns in high res mode
-static bool video_create_hires_textures()
+// create the lookup tables used for decoding hires and lores graphics
+static bool video_create_hires_tables()
 {
 	// create monochrome pattern first
-	glGenTextures(Num_hires_mono_patterns, Hires_mono_textures);
-	for (auto y = 0; y < 128; y++) {
-		Hires_mono_pixels[y] = new uint8_t[3 * Hires_texture_width];
-		memset(Hires_mono_pixels[y], 0, 3 * Hires_texture_width);
-		uint8_t *src = Hires_mono_pixels[y];
-		for (auto x = 0; x < Hires_texture_width - 1; x++) {
-			if ((y >> x) & 1) {
-				*src++ = 0xff;
-				*src++ = 0xff;
-				*src++ = 0xff;
-			}
-			else {
-				src += 3;
-			}
+	for (auto y = 0; y < Num_hires_mono_patterns; y++) {
+		for (auto x = 0; x < Hires_pixels_per_byte; x++) {
+			Hires_mono_pixels[y][x] = ((y >> (x / 2)) & 1) ? Video_white : Video_black;
 		}
-
-		// create the texture
-		glBindTexture(GL_TEXTURE_2D, Hires_mono_textures[y]);
-		glPixelStorei(GL_PACK_ALIGNMENT, 1);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Hires_texture_width, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, Hires_mono_pixels[y]);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	// create the color patterns.  There are essentially four patterns
@@ -253,27 +281,10 @@ static bool video_create_hires_textures()
 	// the bytes that are next to the current byte (i.e. byte 0
 	// for the right edge of a neighboring pixel an byte 6 for
 	// the left edge of a neighboring pixel).  Create 4 sets
-	// of 256 textures that take into account the 4 different
+	// of 256 patterns that take into account the 4 different
 	// possible patterns for the neighboring pixels.  Additionally
-	// we have to create the same set of textures for even/odd
+	// we have to create the same set of patterns for even/odd
 	// scanline columns.
-
-	// texture information for color texture for hires pixel patternsi
-	// pixel array is:
-	// 3 bytes - color information
-	// 8 bytes per pattern (really only 7)
-	// 4 versions of pattern depending on left/right neighbor
-	// 2 versions for odd/even scanline
-	// 256 total patterns
-	glGenTextures(1, &Hires_color_texture);
-	uint32_t texture_size = 3 * Hires_color_texture_width * Num_hires_color_patterns;
-	Hires_color_pixels = new uint8_t[texture_size];
-	memset(Hires_color_pixels, 0, texture_size);
-	uint8_t *pixel = Hires_color_pixels;
-	GLubyte *even_color;
-	GLubyte *odd_color;
-
-	// 256 patterns total
 	for (auto pattern = 0; pattern < Num_hires_color_patterns; pattern++) {
 
 		// loop through potential neighbors of the byte.  We will
@@ -281,25 +292,26 @@ static bool video_create_hires_textures()
 		for (auto column = 0; column < 2; column++) {
 			uint8_t even_index = static_cast<uint8_t>(((pattern & 0x80) ? 2 : 0) + column);
 			uint8_t odd_index = ((pattern & 0x80) ? 2 : 0) + ((even_index + 1) % 2);
-			even_color = Hires_colors[even_index];
-			odd_color = Hires_colors[odd_index];
+			uint32_t even_color = video_pack_color(Hires_colors[even_index]);
+			uint32_t odd_color = video_pack_color(Hires_colors[odd_index]);
 
 			// previous bit will come from neighbor to the right
 			// of the current byte.  Next bit will be the bit to the
 			// right of the current bit, and will eventually
 			// extend to the left of the current byte to the neighbor
 			// to the left
-			for (auto i = 0; i < 4; i++) {
+			for (auto i = 0; i < Num_hires_pattern_variations; i++) {
 				uint8_t right_neighbor = (i & 1);
 				uint8_t left_neighbor = (i >> 1) & 1;
 
 				uint8_t prev_bit = left_neighbor;
 				uint8_t next_bit;
+				uint32_t *pixel = Hires_color_pixels[pattern][column][i];
 
-				// loop through 7 pixels
-				for (auto x = 0; x < Hires_texture_width - 1; x++) {
+				// loop through 7 dots, each is 2 pixels wide
+				for (auto x = 0; x < 7; x++) {
 					uint8_t cur_bit = (pattern >> x) & 1;
-					if (x < Hires_texture_width - 2) {
+					if (x < 6) {
 						next_bit = (pattern >> (x + 1)) & 1;
 					}
 					else {
@@ -308,342 +320,592 @@ static bool video_create_hires_textures()
 
 					// if current bit is on and either the previous
 					// or next bit is on, then this is a white pixel
+					uint32_t color = Video_black;
 					if (cur_bit) {
 						if (prev_bit || next_bit) {
-							pixel[0] = 0xff;
-							pixel[1] = 0xff;
-							pixel[2] = 0xff;
+							color = Video_white;
 						}
 						else {
 							// check column position of current bit
-							if (x & 1) {
-								memcpy(pixel, odd_color, 3);
-							}
-							else {
-								memcpy(pixel, even_color, 3);
-							}
+							color = (x & 1) ? odd_color : even_color;
 						}
 					}
 					else if (prev_bit && next_bit) {
-						if (((x > 0) ? (x - 1) : (x + 1)) & 1) {
-							memcpy(pixel, odd_color, 3);
-						}
-						else {
-							memcpy(pixel, even_color, 3);
-						}
+						color = (((x > 0) ? (x - 1) : (x + 1)) & 1) ? odd_color : even_color;
 					}
 
-					pixel += 3;
+					pixel[x * 2] = color;
+					pixel[x * 2 + 1] = color;
 					prev_bit = cur_bit;
 				}
-
-				pixel += 3;   // skip the 8th pixel
 			}
 		}
 	}
 
-	glBindTexture(GL_TEXTURE_2D, Hires_color_texture);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_size / Num_hires_color_patterns / 3, Num_hires_color_patterns, 0, GL_RGB, GL_UNSIGNED_BYTE, Hires_color_pixels);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	for (auto i = 0; i < Num_lores_colors; i++) {
+		Lores_pixels[i] = video_pack_color(Lores_colors[i]);
+	}
+
+	// the dots of a double hires color are the lores color number
+	// rotated right one bit.  Aux double lores colors are rotated the
+	// same way since aux columns are 7 dots out of phase with main
+	for (auto i = 0; i < Num_lores_colors; i++) {
+		Double_hires_pixels[i] = Lores_pixels[((i << 1) | (i >> 3)) & 0x0f];
+	}
+	for (auto aux = 0; aux < Num_lores_colors; aux++) {
+		for (auto main = 0; main < Num_lores_colors; main++) {
+			uint32_t *pixel = Double_lores_pixels[(aux << 4) | main];
+			for (auto x = 0; x < Double_pixels_per_byte; x++) {
+				pixel[x] = Double_hires_pixels[aux];
+				pixel[x + Double_pixels_per_byte] = Lores_pixels[main];
+			}
+		}
+	}
 
 	return true;
 }
 
-static void video_render_screen(std::function<void(uint16_t, uint16_t)> render_func, std::function<void(uint16_t, uint16_t)>text_func)
+// build the dot patterns for the text characters from the font bitmaps
+static void video_create_text_tables()
 {
-	// and secondary mode.  The mode might be all text, or
-	// might be lores + text
-	if (!(Video_mode & VIDEO_MODE_MIXED)) {
-		for (uint16_t y = 0; y < Num_vertical_cells; y++) {
-			for (uint16_t x = 0; x < Num_horizontal_cells; x++) {
-				render_func(x, y);
+	font *fonts[NUM_TEXT_FONTS] = { &Video_font, &Video_inverse_font, &Video_font_80, &Video_inverse_font_80 };
+	for (auto f = 0; f < NUM_TEXT_FONTS; f++) {
+		uint32_t width = (f < TEXT_FONT_80_NORMAL) ? Text_char_width : Text80_char_width;
+		for (auto c = 0; c < Num_font_chars; c++) {
+			for (auto y = 0; y < Num_text_font_rows; y++) {
+				uint16_t dots = 0;
+				for (uint32_t x = 0; x < width; x++) {
+					if (fonts[f]->pixel_on(static_cast<uint8_t>(c), x, y)) {
+						dots |= (1 << x);
+					}
+				}
+				Video_text_glyphs[f][c][y] = dots;
 			}
 		}
 	}
-	else {
-		for (uint16_t y = 0; y < Num_vertical_cells_mixed; y++) {
-			for (uint16_t x = 0; x < Num_horizontal_cells; x++) {
-				render_func(x, y);
-			}
+
+	for (auto dots = 0; dots < 128; dots++) {
+		for (auto x = 0; x < 7; x++) {
+			Video_dot_pixels[dots][x] = ((dots >> x) & 1) ? Video_white : Video_black;
 		}
+	}
+}
 
-		for (uint16_t y = Num_vertical_cells_mixed; y < Num_vertical_cells; y++) {
-			for (uint16_t x = 0; x < Num_horizontal_cells; x++) {
-				text_func(x, y);
+// get the font to use for the character.  Normal, inverse or
+// flashing (which alternates between the two)
+static const uint16_t *video_get_glyph(uint8_t c1, const char *conv_array, int normal_font)
+{
+	int font_index = normal_font;
+	if (c1 <= 0x3f) {
+		font_index = normal_font + 1;
+	}
+	else if ((c1 <= 0x7f) && (Video->m_flash == true)) {
+		// set inverse if flashing is true
+		font_index = normal_font + 1;
+	}
+
+	// get character in memory, and then convert to ASCII.  We get character
+	// value from memory and then subtract out the first character in our
+	// font (as we need to be 0-based from that point).
+	uint8_t c = static_cast<uint8_t>(conv_array[c1] - Video_font.m_header.m_char_offset);
+	return Video_text_glyphs[font_index][c & (Num_font_chars - 1)];
+}
+
+// the decoders below each fill in one scanline (0-191) of the screen,
+// which is two rows of the framebuffer.  src points to the first byte
+// of the line in memory.  The text decoders return true when the line
+// has flashing characters on it
+static bool video_render_text_line(uint32_t *dest, int line, const uint8_t *src, const char *conv_array)
+{
+	int font_row = (line % 8) * 2;
+	bool flashing = false;
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		uint8_t c1 = src[x];
+		flashing |= (c1 >= 0x40 && c1 <= 0x7f);
+		const uint16_t *glyph = video_get_glyph(c1, conv_array, TEXT_FONT_NORMAL);
+		for (auto row = 0; row < 2; row++) {
+			uint16_t dots = glyph[font_row + row];
+			uint32_t *pixel = dest + (row * Video_native_width) + (x * Text_char_width);
+			memcpy(pixel, Video_dot_pixels[dots & 0x7f], 7 * sizeof(uint32_t));
+			memcpy(pixel + 7, Video_dot_pixels[dots >> 7], 7 * sizeof(uint32_t));
+		}
+	}
+	return flashing;
+}
+
+static bool video_render_text80_line(uint32_t *dest, int line, const uint8_t *aux_src, const uint8_t *main_src, const char *conv_array)
+{
+	int font_row = (line % 8) * 2;
+	bool flashing = false;
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		// aux memory holds the even columns
+		uint8_t character[2];
+		character[0] = aux_src[x];
+		character[1] = main_src[x];
+		for (auto i = 0; i < 2; i++) {
+			flashing |= (character[i] >= 0x40 && character[i] <= 0x7f);
+			const uint16_t *glyph = video_get_glyph(character[i], conv_array, TEXT_FONT_80_NORMAL);
+			for (auto row = 0; row < 2; row++) {
+				uint32_t *pixel = dest + (row * Video_native_width) + (x * Text_char_width) + (i * Text80_char_width);
+				memcpy(pixel, Video_dot_pixels[glyph[font_row + row]], 7 * sizeof(uint32_t));
 			}
 		}
 	}
+	return flashing;
+}
 
+static void video_render_lores_line(uint32_t *dest, int line, const uint8_t *src)
+{
+	// top half of the cell is the low nibble, bottom half the high nibble
+	int shift = (line % 8) < 4 ? 0 : 4;
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		uint32_t color = Lores_pixels[(src[x] >> shift) & 0x0f];
+		uint32_t *pixel = dest + (x * Video_cell_width);
+		for (auto i = 0; i < Video_cell_width; i++) {
+			pixel[i] = color;
+		}
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
 }
 
-void video_render()
+static void video_render_mono_hires_line(uint32_t *dest, const uint8_t *src)
 {
-	bool primary = (!(Video_mode & VIDEO_MODE_PAGE2) || (Video_mode & VIDEO_MODE_80COL)) ? true : false;
-	uint16_t *gr_addr_map = nullptr;
-	uint16_t *text_addr_map = nullptr;
-	char *conv_array = nullptr;
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		// mono mode - we don't care about the high bit in the display byte
+		uint8_t byte = src[x] & 0x7f;
+		memcpy(dest + (x * Hires_pixels_per_byte), Hires_mono_pixels[byte], Hires_pixels_per_byte * sizeof(uint32_t));
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
+}
+
+static void video_render_color_hires_line(uint32_t *dest, const uint8_t *src)
+{
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		uint8_t byte = src[x];
+		uint8_t left_neighbor = x > 0 ? (src[x - 1] >> 6) & 1 : 0;
+		uint8_t right_neighbor = x < Num_horizontal_cells - 1 ? src[x + 1] & 1 : 0;
+		const uint32_t *pattern = Hires_color_pixels[byte][x & 1][left_neighbor * 2 + right_neighbor];
+		memcpy(dest + (x * Hires_pixels_per_byte), pattern, Hires_pixels_per_byte * sizeof(uint32_t));
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
+}
+
+// the double graphics decoders take the line from both aux and main
+// memory.  Aux memory holds the left half of each column
+static void video_render_double_lores_line(uint32_t *dest, int line, const uint8_t *aux_src, const uint8_t *main_src)
+{
+	int shift = (line % 8) < 4 ? 0 : 4;
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		uint8_t colors = (((aux_src[x] >> shift) & 0x0f) << 4) | ((main_src[x] >> shift) & 0x0f);
+		memcpy(dest + (x * Hires_pixels_per_byte), Double_lores_pixels[colors], Hires_pixels_per_byte * sizeof(uint32_t));
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
+}
+
+static void video_render_double_mono_hires_line(uint32_t *dest, const uint8_t *aux_src, const uint8_t *main_src)
+{
+	// each byte is 7 dots, one pixel each
+	for (auto x = 0; x < Num_horizontal_cells; x++) {
+		uint32_t *pixel = dest + (x * Hires_pixels_per_byte);
+		memcpy(pixel, Video_dot_pixels[aux_src[x] & 0x7f], Double_pixels_per_byte * sizeof(uint32_t));
+		memcpy(pixel + Double_pixels_per_byte, Video_dot_pixels[main_src[x] & 0x7f], Double_pixels_per_byte * sizeof(uint32_t));
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
+}
+
+static void video_render_double_color_hires_line(uint32_t *dest, const uint8_t *aux_src, const uint8_t *main_src)
+{
+	// two columns (4 bytes) are 28 dots, which is exactly 7 colors
+	for (auto x = 0; x < Num_horizontal_cells; x += 2) {
+		uint32_t dots = (aux_src[x] & 0x7f) | ((main_src[x] & 0x7f) << 7) |
+			((aux_src[x + 1] & 0x7f) << 14) | ((main_src[x + 1] & 0x7f) << 21);
+		uint32_t *pixel = dest + (x * Hires_pixels_per_byte);
+		for (auto i = 0; i < 7; i++) {
+			uint32_t color = Double_hires_pixels[dots & 0x0f];
+			pixel[0] = color;
+			pixel[1] = color;
+			pixel[2] = color;
+			pixel[3] = color;
+			pixel += 4;
+			dots >>= 4;
+		}
+	}
+	memcpy(dest + Video_native_width, dest, Video_native_width * sizeof(uint32_t));
+}
+
+// position of the beam in the current pass, in cycles
+static uint32_t video_get_beam_cycle()
+{
+	return static_cast<uint32_t>(Machine->m_total_cycles % Cycles_per_frame);
+}
+
+// mode a line was displayed with, given the mode at the start of a pass
+// and the changes logged during it
+static uint8_t video_get_pass_line_mode(int line)
+{
+	uint32_t line_cycle = line * Horz_state_counter + Video_hblank_cycles;
+	uint8_t mode = Video->m_pass_start_mode;
+	for (uint32_t i = 0; i < Video->m_mode_log_count && Video->m_mode_log[i].m_cycle <= line_cycle; i++) {
+		mode = Video->m_mode_log[i].m_mode;
+	}
+	return mode;
+}
 
-	text_addr_map = primary ? Video_primary_text_map : Video_secondary_text_map;
-	if (!(Video_mode & VIDEO_MODE_HIRES)) {
-		gr_addr_map = primary ? Video_primary_text_map : Video_secondary_text_map;  // m_screen_map[row] + col;
+// starts a new log if the beam has moved on to a new pass since the
+// last change was logged.  mode is the mode in effect at the end of the
+// old pass
+static void video_start_pass(uint8_t mode)
+{
+	uint64_t pass_start_cycle = Machine->m_total_cycles - video_get_beam_cycle();
+	if (pass_start_cycle == Video->m_pass_start_cycle) {
+		return;
 	}
-	else if (Video_mode & VIDEO_MODE_HIRES) {
-		gr_addr_map = primary ? Video_hires_map : Video_hires_secondary_map;
+
+	// the old log covers exactly the last full pass, so keep its modes per line
+	if (pass_start_cycle - Video->m_pass_start_cycle == Cycles_per_frame) {
+		for (auto line = 0; line < Num_video_lines; line++) {
+			Video->m_last_pass_modes[line] = video_get_pass_line_mode(line);
+		}
+	} else {
+		// if the beam went through more than one pass since the last change
+		// then the last full pass was all in the same mode
+		memset(Video->m_last_pass_modes, mode, sizeof(Video->m_last_pass_modes));
+	}
+
+	Video->m_pass_start_cycle = pass_start_cycle;
+	Video->m_pass_start_mode = mode;
+	Video->m_mode_log_count = 0;
+}
+
+// log a change to the video mode at the current beam position
+static void video_log_mode_change(uint8_t old_mode)
+{
+	video_start_pass(old_mode);
+
+	// too many changes in one pass would only be a program flipping
+	// switches as fast as it can.  Just keep the last mode then
+	if (Video->m_mode_log_count == Video_max_mode_changes) {
+		Video->m_mode_log_count--;
+	}
+	Video->m_mode_log[Video->m_mode_log_count].m_cycle = video_get_beam_cycle();
+	Video->m_mode_log[Video->m_mode_log_count].m_mode = Video->m_mode;
+	Video->m_mode_log_count++;
+}
+
+// get the mode for every line on the screen.  Lines the beam has already
+// drawn this pass use this pass's modes, the rest are still showing
+// what was drawn on the last pass
+static void video_get_line_modes(uint8_t *line_modes)
+{
+	video_start_pass(Video->m_mode);
+	uint32_t beam_cycle = video_get_beam_cycle();
+	for (auto line = 0; line < Num_video_lines; line++) {
+		if (line * Horz_state_counter + Video_hblank_cycles <= beam_cycle) {
+			line_modes[line] = video_get_pass_line_mode(line);
+		} else {
+			line_modes[line] = Video->m_last_pass_modes[line];
+		}
 	}
+}
+
+// true while the beam is in vertical blanking
+static bool video_in_vbl()
+{
+	return video_get_beam_cycle() >= Num_video_lines * Horz_state_counter;
+}
+
+// force the whole screen to be decoded on the next render (i.e. when
+// something else has been drawn in the framebuffer texture)
+void video_invalidate()
+{
+	Video->m_render_valid = false;
+}
+
+// decode the screen into the framebuffer.  Only scanlines whose memory
+// was written (or whose memory changed because of paging) since the
+// last render are decoded again.  Returns true if anything was redrawn
+bool video_render()
+{
+	char *conv_array = nullptr;
 
 	// figure out which chracter set based on emulator type
-	if (Emulator_type <= emulator_type::APPLE2_PLUS) {
+	if (Machine->m_type <= emulator_type::APPLE2_PLUS) {
 		conv_array = character_conv;
 	} else {
 		conv_array = character_conv_2e;
 	}
 
-	auto render_text_cell = [text_addr_map, conv_array](uint16_t x, uint16_t y) -> void {
-		font *cur_font;
-		uint16_t addr = text_addr_map[y] + x;
-		uint8_t c1 = memory_read(addr);
-		int x_pixel = x * Video_cell_width;
-		int y_pixel = y * Video_cell_height;
-
-		// get normal or inverse font
-		if (c1 <= 0x3f) {
-			cur_font = &Video_inverse_font;
+	// anything that changes how every line is decoded means the
+	// whole screen needs redrawn
+	if (Video->m_tint_type != Video->m_render_tint || conv_array != Video->m_render_conv_array) {
+		Video->m_render_valid = false;
+	}
+	bool flash_changed = (Video->m_flash != Video->m_render_flash);
+
+	// each line is drawn in the mode it had when the beam went by
+	uint8_t line_modes[Num_video_lines];
+	video_get_line_modes(line_modes);
+
+	uint32_t lines_redrawn = 0;
+	for (auto line = 0; line < Num_video_lines; line++) {
+		uint8_t mode = line_modes[line];
+		bool primary = (!(mode & VIDEO_MODE_PAGE2) || (mode & VIDEO_MODE_80COL)) ? true : false;
+		uint16_t *text_addr_map = primary ? Video_primary_text_map : Video_secondary_text_map;
+		uint16_t *gr_addr_map = text_addr_map;
+		if (mode & VIDEO_MODE_HIRES) {
+			gr_addr_map = primary ? Video_hires_map : Video_hires_secondary_map;
 		}
-		else if ((c1 <= 0x7f) && (Video_flash == true)) {
-			// set inverse if flashing is true
-			cur_font = &Video_inverse_font;
+
+		// the mode might be all text, or might be graphics + text.  Text
+		// at the bottom of a mixed screen is 40 columns unless the
+		// graphics are double hires/lores
+		bool text = (mode & VIDEO_MODE_TEXT) || ((mode & VIDEO_MODE_MIXED) && line >= Num_video_lines_mixed);
+		bool double_graphics = (mode & VIDEO_MODE_80COL) && (mode & VIDEO_MODE_DHIRES);
+		bool text80 = false;
+		const uint8_t *src[2] = { nullptr, nullptr };
+		if (text) {
+			uint16_t addr = text_addr_map[line / 8];
+			if ((mode & VIDEO_MODE_80COL) && ((mode & VIDEO_MODE_TEXT) || double_graphics)) {
+				text80 = true;
+				src[0] = memory_get_aux_page(addr) + (addr & 0xff);
+				src[1] = memory_get_main_page(addr) + (addr & 0xff);
+			} else {
+				src[0] = memory_get_read_page(addr) + (addr & 0xff);
+			}
 		}
 		else {
-			cur_font = &Video_font;
+			uint16_t addr = gr_addr_map[line / 8];
+			if (mode & VIDEO_MODE_HIRES) {
+				addr += (1024 * (line % 8));
+			}
+			if (double_graphics) {
+				src[0] = memory_get_aux_page(addr) + (addr & 0xff);
+				src[1] = memory_get_main_page(addr) + (addr & 0xff);
+			} else {
+				src[0] = memory_get_read_page(addr) + (addr & 0xff);
+			}
 		}
 
-		// get character in memory, and then convert to ASCII.  We get character
-		// value from memory and then subtract out the first character in our
-		// font (as we need to be 0-based from that point).  Then we can get
-		// the row/col in the bitmap sheet where the character is
-		uint8_t c = conv_array[c1];
-		c -= cur_font->m_header.m_char_offset;
-
-		glBindTexture(GL_TEXTURE_2D, cur_font->m_texture_id);
-		glColor3f(1.0f, 1.0f, 1.0f);
-		glBegin(GL_QUADS);
-		glTexCoord2f(cur_font->m_char_u[c], cur_font->m_char_v[c]); glVertex2i(x_pixel, y_pixel);
-		glTexCoord2f(cur_font->m_char_u[c] + cur_font->m_cell_u, cur_font->m_char_v[c]);  glVertex2i(x_pixel + Video_cell_width, y_pixel);
-		glTexCoord2f(cur_font->m_char_u[c] + cur_font->m_cell_u, cur_font->m_char_v[c] + cur_font->m_cell_v); glVertex2i(x_pixel + Video_cell_width, y_pixel + Video_cell_height);
-		glTexCoord2f(cur_font->m_char_u[c], cur_font->m_char_v[c] + cur_font->m_cell_v); glVertex2i(x_pixel, y_pixel + Video_cell_height);
-		glEnd();
-		glBindTexture(GL_TEXTURE_2D, 0);
-	};
-
-	auto render_text80_cell = [text_addr_map, conv_array](uint16_t x, uint16_t y) -> void {
-		font *cur_font;
-		uint16_t addr = text_addr_map[y] + x;
-		uint8_t character[2];
-		character[0] = memory_read_aux(addr);
-		character[1] = memory_read_main(addr);
-		int x_pixel = x * Video_cell_width;
-		int y_pixel = y * Video_cell_height;
+		video_line_state &state = Video->m_line_states[line];
+		bool redraw = (Video->m_render_valid == false) || (mode != state.m_mode) || (src[0] != state.m_src[0]) || (src[1] != state.m_src[1]) ||
+			(memory_dirty_flag(src[0]) & Memory_dirty_video) || (src[1] != nullptr && (memory_dirty_flag(src[1]) & Memory_dirty_video)) ||
+			(flash_changed && state.m_flashing);
+		if (redraw == false) {
+			continue;
+		}
 
-		// get normal or inverse font
-		for (auto i = 0; i < 2; i++) {
-			if (character[i] <= 0x3f) {
-				cur_font = &Video_inverse_font_80;
+		uint32_t *dest = &Video->m_framebuffer[line * 2 * Video_native_width];
+		state.m_src[0] = src[0];
+		state.m_src[1] = src[1];
+		state.m_mode = mode;
+		state.m_flashing = false;
+		if (text) {
+			if (text80) {
+				state.m_flashing = video_render_text80_line(dest, line, src[0], src[1], conv_array);
+			} else {
+				state.m_flashing = video_render_text_line(dest, line, src[0], conv_array);
+			}
+		}
+		else if (double_graphics) {
+			if (!(mode & VIDEO_MODE_HIRES)) {
+				video_render_double_lores_line(dest, line, src[0], src[1]);
 			}
-			else if ((character[i] <= 0x7f) && (Video_flash == true)) {
-				// set inverse if flashing is true
-				cur_font = &Video_inverse_font_80;
+			else if (Video->m_tint_type != video_tint_types::COLOR) {
+				video_render_double_mono_hires_line(dest, src[0], src[1]);
 			}
 			else {
-				cur_font = &Video_font_80;
+				video_render_double_color_hires_line(dest, src[0], src[1]);
 			}
-
-			// get character in memory, and then convert to ASCII.  We get character
-			// value from memory and then subtract out the first character in our
-			// font (as we need to be 0-based from that point).  Then we can get
-			// the row/col in the bitmap sheet where the character is
-			uint8_t c = conv_array[character[i]];
-			c -= cur_font->m_header.m_char_offset;
-
-			glBindTexture(GL_TEXTURE_2D, cur_font->m_texture_id);
-			glColor3f(1.0f, 1.0f, 1.0f);
-			glBegin(GL_QUADS);
-			glTexCoord2f(cur_font->m_char_u[c], cur_font->m_char_v[c]); glVertex2i(x_pixel, y_pixel);
-			glTexCoord2f(cur_font->m_char_u[c] + cur_font->m_cell_u, cur_font->m_char_v[c]);  glVertex2i(x_pixel + (Video_cell_width/2), y_pixel);
-			glTexCoord2f(cur_font->m_char_u[c] + cur_font->m_cell_u, cur_font->m_char_v[c] + cur_font->m_cell_v); glVertex2i(x_pixel + (Video_cell_width/2), y_pixel + Video_cell_height);
-			glTexCoord2f(cur_font->m_char_u[c], cur_font->m_char_v[c] + cur_font->m_cell_v); glVertex2i(x_pixel, y_pixel + Video_cell_height);
-			glEnd();
-			glBindTexture(GL_TEXTURE_2D, 0);
-
-			x_pixel += (Video_cell_width/2);
 		}
-	};
-
-	auto render_lores_cell = [gr_addr_map](uint16_t x, uint16_t y) -> void {
-		// get the 2 nibble value of the color.  Blit the corresponding colors
-		// to the screen
-		uint16_t addr = gr_addr_map[y] + x;
-		uint8_t c = memory_read(addr);
-		int x_pixel = x * Video_cell_width;
-		int y_pixel = y * Video_cell_height;
-
-		// render top cell
-		uint8_t color = c & 0x0f;
-		glColor3ub(Lores_colors[color][0], Lores_colors[color][1], Lores_colors[color][2]);
-		glBegin(GL_QUADS);
-		glVertex2i(x_pixel, y_pixel);
-		glVertex2i(x_pixel + Video_cell_width, y_pixel);
-		glVertex2i(x_pixel + Video_cell_width, y_pixel + (Video_cell_height / 2));
-		glVertex2i(x_pixel, y_pixel + (Video_cell_height / 2));
-		glEnd();
-
-		// render bottom cell
-		color = (c & 0xf0) >> 4;
-		glColor3ub(Lores_colors[color][0], Lores_colors[color][1], Lores_colors[color][2]);
-		glBegin(GL_QUADS);
-		glVertex2i(x_pixel, y_pixel + (Video_cell_height / 2));
-		glVertex2i(x_pixel + Video_cell_width, y_pixel + (Video_cell_height / 2));
-		glVertex2i(x_pixel + Video_cell_width, y_pixel + Video_cell_height);
-		glVertex2i(x_pixel, y_pixel + Video_cell_height);
-		glEnd();
-	};
-
-	auto render_mono_hires_cell = [gr_addr_map](uint16_t x, uint16_t y) -> void {
-		int y_pixel = y * Video_cell_height;
-		for (uint8_t b = 0; b < 8; b++) {
-			int x_pixel = x * Video_cell_width;
-			uint16_t memory_loc = gr_addr_map[y] + (1024 * b) + x;
-			uint8_t byte = memory_read(memory_loc);
-			if (byte) {
-				// mono mode - we don't care about the high bit in the display byte
-				byte &= 0x7f;
-				glBindTexture(GL_TEXTURE_2D, Hires_mono_textures[byte]);
-				glColor3f(1.0f, 1.0f, 1.0f);
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 0.0f); glVertex2i(x_pixel, y_pixel);
-				glTexCoord2f(1.0f, 0.0f); glVertex2i(x_pixel + Video_cell_width+2, y_pixel);
-				glTexCoord2f(1.0f, 1.0f); glVertex2i(x_pixel + Video_cell_width+2, y_pixel + 2);
-				glTexCoord2f(0.0f, 1.0f); glVertex2i(x_pixel, y_pixel + 2);
-				glEnd();
-			}
-			y_pixel += 2;
+		else if (!(mode & VIDEO_MODE_HIRES)) {
+			video_render_lores_line(dest, line, src[0]);
 		}
-	};
-
-	auto render_color_hires_cell = [gr_addr_map](uint16_t x, uint16_t y) -> void {
-		int odd = x % 2;
-		int y_pixel = y * Video_cell_height;
-		for (uint8_t b = 0; b < 8; b++) {
-			int x_pixel = x * Video_cell_width;
-			uint16_t memory_loc = gr_addr_map[y] + (1024 * b) + x;
-			uint8_t byte = memory_read(memory_loc);
-			uint8_t left_neighbor = ((x > 0 ? memory_read(memory_loc - 1) : 0) >> 6) & 1;
-			uint8_t right_neighbor = (x < 39 ? memory_read(memory_loc + 1) : 0) & 1;
-			if (byte) {
-				float u, v;
-
-				uint32_t column = ((odd & 1) ? 4 : 0) + (left_neighbor * 2 + right_neighbor);
-				u = (column * 8.0f) / (float)Hires_color_texture_width;
-				v = byte / (float)Num_hires_color_patterns;
-				glBindTexture(GL_TEXTURE_2D, Hires_color_texture);
-				glColor3f(1.0f, 1.0f, 1.0f);
-				glBegin(GL_QUADS);
-				glTexCoord2f(u, v); glVertex2i(x_pixel, y_pixel);
-				glTexCoord2f(u + (7.0f / (float)Hires_color_texture_width), v); glVertex2i(x_pixel + Video_cell_width, y_pixel);
-				glTexCoord2f(u + (7.0f / (float)Hires_color_texture_width), v + (1.0f / (float)Num_hires_color_patterns)); glVertex2i(x_pixel + Video_cell_width, y_pixel + 2);
-				glTexCoord2f(u, v + (1.0f / (float)Num_hires_color_patterns)); glVertex2i(x_pixel, y_pixel + 2);
-				glEnd();
-			}
-			y_pixel += 2;
+		else if (Video->m_tint_type != video_tint_types::COLOR) {
+			video_render_mono_hires_line(dest, src[0]);
 		}
-	};
+		else {
+			video_render_color_hires_line(dest, src[0]);
+		}
+		lines_redrawn++;
+	}
 
-	std::function<void(uint16_t, uint16_t)> main_func;
-	if (Video_mode & VIDEO_MODE_TEXT) {
-		if (Video_mode & VIDEO_MODE_80COL) {
-			main_func = render_text80_cell;
-		} else {
-			main_func = render_text_cell;
+	// everything on screen is now up to date.  Flags are cleared after
+	// all lines are done since several lines share a memory page
+	for (auto line = 0; line < Num_video_lines; line++) {
+		memory_dirty_flag(Video->m_line_states[line].m_src[0]) &= ~Memory_dirty_video;
+		if (Video->m_line_states[line].m_src[1] != nullptr) {
+			memory_dirty_flag(Video->m_line_states[line].m_src[1]) &= ~Memory_dirty_video;
 		}
 	}
-	else if (!(Video_mode & VIDEO_MODE_HIRES)) {
-		main_func = render_lores_cell;
+
+	Video->m_render_valid = true;
+	Video->m_render_tint = Video->m_tint_type;
+	Video->m_render_conv_array = conv_array;
+	Video->m_render_flash = Video->m_flash;
+
+	// keep stats over a second's worth of frames
+	Video->m_render_stats.m_frames++;
+	Video->m_render_stats.m_lines += lines_redrawn;
+	if (lines_redrawn == 0) {
+		Video->m_render_stats.m_frames_skipped++;
+	}
+	if (Video->m_render_stats.m_frames >= Frames_per_second) {
+		Video->m_render_stats_last_second = Video->m_render_stats;
+		Video->m_render_stats = video_render_stats();
 	}
-	else if (Video_mode & VIDEO_MODE_HIRES) {
 
-		if (Video_tint_type != video_tint_types::COLOR) {
-			main_func = render_mono_hires_cell;
-		}
-		else {
-			main_func = render_color_hires_cell;
+	return lines_redrawn > 0;
+}
+
+// returns the framebuffer for the last rendered screen.
+// Video_native_width x Video_native_height RGBA pixels
+const uint32_t *video_get_framebuffer()
+{
+	return Video->m_framebuffer;
+}
+
+// write the framebuffer out as a binary ppm file
+bool video_save_screenshot(const char *filename)
+{
+	FILE *fp = fopen(filename, "wb");
+	if (fp == nullptr) {
+		printf("Unable to open %s for writing screenshot\n", filename);
+		return false;
+	}
+	fprintf(fp, "P6\n%d %d\n255\n", Video_native_width, Video_native_height);
+	uint8_t row[Video_native_width * 3];
+	for (auto y = 0; y < Video_native_height; y++) {
+		const uint32_t *pixel = &Video->m_framebuffer[y * Video_native_width];
+		for (auto x = 0; x < Video_native_width; x++) {
+			row[x * 3] = pixel[x] & 0xff;
+			row[x * 3 + 1] = (pixel[x] >> 8) & 0xff;
+			row[x * 3 + 2] = (pixel[x] >> 16) & 0xff;
 		}
+		fwrite(row, 1, sizeof(row), fp);
 	}
-	video_render_screen(main_func, render_text_cell);
+	fclose(fp);
+	return true;
+}
 
+// convert a character on the text screen to ascii.  Inverse and
+// flashing characters are only uppercase
+static char video_text_to_ascii(uint8_t c)
+{
+	c = (c < 0x80) ? (c & 0x3f) : (c & 0x7f);
+	if (c < 0x20) {
+		c += 0x40;
+	}
+	return static_cast<char>(c);
 }
 
-uint8_t video_set_state(uint16_t addr, uint8_t val, bool write)
+// the text screen as ascii, one line per row (80 characters wide when
+// 80 column mode is on).  Used when there is no window to look at
+std::string video_get_screen_text()
 {
-	UNREFERENCED(write);
-	UNREFERENCED(val);
+	bool primary = (!(Video->m_mode & VIDEO_MODE_PAGE2) || (Video->m_mode & VIDEO_MODE_80COL)) ? true : false;
+	uint16_t *text_addr_map = primary ? Video_primary_text_map : Video_secondary_text_map;
+
+	std::string text;
+	for (auto y = 0; y < Num_vertical_cells; y++) {
+		uint16_t addr = text_addr_map[y];
+		if (Video->m_mode & VIDEO_MODE_80COL) {
+			const uint8_t *aux_src = memory_get_aux_page(addr) + (addr & 0xff);
+			const uint8_t *main_src = memory_get_main_page(addr) + (addr & 0xff);
+			for (auto x = 0; x < Num_horizontal_cells; x++) {
+				text += video_text_to_ascii(aux_src[x]);
+				text += video_text_to_ascii(main_src[x]);
+			}
+		} else {
+			const uint8_t *src = memory_get_read_page(addr) + (addr & 0xff);
+			for (auto x = 0; x < Num_horizontal_cells; x++) {
+				text += video_text_to_ascii(src[x]);
+			}
+		}
+		text += '\n';
+	}
+	return text;
+}
 
+static void video_set_state(uint16_t addr)
+{
 	uint8_t a = addr & 0xff;
+	uint8_t old_mode = Video->m_mode;
 
 	// switch based on the address to set the video modes
 	switch (a) {
 	case 0x0c:
-		Video_mode &= ~VIDEO_MODE_80COL;
+		Video->m_mode &= ~VIDEO_MODE_80COL;
 		break;
 	case 0x0d:
-		Video_mode |= VIDEO_MODE_80COL;
+		Video->m_mode |= VIDEO_MODE_80COL;
 		break;
 	case 0x0e:
-		Video_mode &= ~VIDEO_MODE_ALTCHAR;
+		Video->m_mode &= ~VIDEO_MODE_ALTCHAR;
 		break;
 	case 0x0f:
-		Video_mode |= VIDEO_MODE_ALTCHAR;
+		Video->m_mode |= VIDEO_MODE_ALTCHAR;
 		break;
 	case 0x50:
-		Video_mode &= ~VIDEO_MODE_TEXT;
+		Video->m_mode &= ~VIDEO_MODE_TEXT;
 		break;
 	case 0x51:
-		Video_mode |= VIDEO_MODE_TEXT;
+		Video->m_mode |= VIDEO_MODE_TEXT;
 		break;
 	case 0x52:
-		Video_mode &= ~VIDEO_MODE_MIXED;
+		Video->m_mode &= ~VIDEO_MODE_MIXED;
 		break;
 	case 0x53:
-		Video_mode |= VIDEO_MODE_MIXED;
+		Video->m_mode |= VIDEO_MODE_MIXED;
 		break;
 	case 0x54:
-		Video_mode &= ~VIDEO_MODE_PAGE2;
+		Video->m_mode &= ~VIDEO_MODE_PAGE2;
 		break;
 	case 0x55:
-		Video_mode |= VIDEO_MODE_PAGE2;
+		Video->m_mode |= VIDEO_MODE_PAGE2;
 		break;
 	case 0x56:
-		Video_mode &= ~VIDEO_MODE_HIRES;
+		Video->m_mode &= ~VIDEO_MODE_HIRES;
 		break;
 	case 0x57:
-		Video_mode |= VIDEO_MODE_HIRES;
+		Video->m_mode |= VIDEO_MODE_HIRES;
+		break;
+
+	// annunciator 3.  Turning it off turns on double hires/lores
+	// (when 80 column is also on)
+	case 0x5e:
+		Video->m_mode |= VIDEO_MODE_DHIRES;
+		break;
+	case 0x5f:
+		Video->m_mode &= ~VIDEO_MODE_DHIRES;
 		break;
 	}
 
-	memory_set_paging_tables();
+	if (Video->m_mode != old_mode) {
+		video_log_mode_change(old_mode);
+	}
+
+	// page2 and hires can change paging when 80STORE is on
+	memory_update_paging_tables(Memory->m_state, old_mode);
+}
 
+// both reads and writes of the video soft switches change the mode
+uint8_t video_soft_switch_read(void *context, uint16_t addr)
+{
+	UNREFERENCED(context);
+	video_set_state(addr);
 	return 0xff;
 	//return memory_read_floating_bus();;
 }
 
-uint8_t video_get_state(uint16_t addr, uint8_t val, bool write)
+void video_soft_switch_write(void *context, uint16_t addr, uint8_t val)
 {
-	UNREFERENCED(write);
+	UNREFERENCED(context);
 	UNREFERENCED(val);
+	video_set_state(addr);
+}
 
+uint8_t video_get_state(uint16_t addr)
+{
 	uint8_t return_val = 0xff;
 
 	addr = addr & 0xff;
@@ -651,26 +913,26 @@ uint8_t video_get_state(uint16_t addr, uint8_t val, bool write)
 	switch(addr) {
 
 	// these are video modes
-	case 0x19:   // VBL
-		return_val = 0;
+	case 0x19:   // VBL (active low)
+		return_val = video_in_vbl() ? 0 : 1;
 		break;
 	case 0x1a:   // TEXT switch
-		return_val = Video_mode & VIDEO_MODE_TEXT ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_TEXT ? 1 : 0;
 		break;
 	case 0x1b:   // MIXED switch
-		return_val = Video_mode & VIDEO_MODE_MIXED ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_MIXED ? 1 : 0;
 		break;
 	case 0x1c:   // PAGE2 switch
-		return_val = Video_mode & VIDEO_MODE_PAGE2 ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_PAGE2 ? 1 : 0;
 		break;
 	case 0x1d:   // HIRES switch
-		return_val = Video_mode & VIDEO_MODE_HIRES ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_HIRES ? 1 : 0;
 		break;
 	case 0x1e:   // ALTCHAR switch
-		return_val = Video_mode & VIDEO_MODE_ALTCHAR ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_ALTCHAR ? 1 : 0;
 		break;
 	case 0x1f:   // 80COL switch
-		return_val = Video_mode & VIDEO_MODE_80COL ? 1 : 0;
+		return_val = Video->m_mode & VIDEO_MODE_80COL ? 1 : 0;
 		break;
 	}
 	if (return_val) {
@@ -680,29 +942,26 @@ uint8_t video_get_state(uint16_t addr, uint8_t val, bool write)
 	return return_val;// | memory_read_floating_bus();
 }
 
-// intialize the SDL system
-bool video_init()
+// load the fonts and build the lookup tables and screen maps
+static void video_create_tables()
 {
 	if (Video_font.load("apple_font.bff") == false) {
-		return false;
+		return;
 	}
 	if (Video_inverse_font.load("apple_font_inverted.bff") == false) {
-		return false;
+		return;
 	}
 	if (Video_font_80.load("apple_font80.bff") == false) {
-		return false;
+		return;
 	}
 	if (Video_inverse_font_80.load("apple_font80_inverted.bff") == false) {
-		return false;
+		return;
 	}
 
-	if (video_create_hires_textures() == false) {
-		return false;
+	if (video_create_hires_tables() == false) {
+		return;
 	}
-
-	// set up a timer for flashing cursor
-	Video_flash = false;
-	Video_flash_timer = SDL_AddTimer(250, timer_flash_callback, nullptr);
+	video_create_text_tables();
 
 	// set up screen map for video output.  This per/row
 	// table gets starting memory address for that row of text
@@ -717,31 +976,87 @@ bool video_init()
 		Video_hires_secondary_map[i] = Video_hires_map[i] + 0x2000;
 	}
 
+	Video_tables_valid = true;
+}
+
+// intialize the SDL system
+bool video_init()
+{
+	// memory has been reset, so the screen all needs decoding again
+	video_invalidate();
+
+	// start logging mode changes from the current beam position
+	Video->m_pass_start_cycle = Machine->m_total_cycles - video_get_beam_cycle();
+	Video->m_pass_start_mode = Video->m_mode;
+	Video->m_mode_log_count = 0;
+	memset(Video->m_last_pass_modes, Video->m_mode, sizeof(Video->m_last_pass_modes));
+
+	std::call_once(Video_tables_built, video_create_tables);
+	if (Video_tables_valid == false) {
+		return false;
+	}
+
+	// set up an event for flashing cursor
+	Video->m_flash = false;
+	scheduler_add_event(Machine->m_total_cycles + Video_flash_cycles, video_flash_callback, nullptr);
+
 	return true;
 }
 
-void video_shutdown()
+// the display mode and the beam timing of the mode changes.  The
+// framebuffer isn't saved, it is decoded again from memory
+void video_save_state(snapshot_writer &writer)
+{
+	uint64_t flash_cycle = 0;
+	scheduler_find_event(video_flash_callback, nullptr, flash_cycle);
+
+	writer.write(Video->m_mode);
+	writer.write(Video->m_flash);
+	writer.write(flash_cycle);
+	writer.write(Video->m_pass_start_cycle);
+	writer.write(Video->m_pass_start_mode);
+	writer.write(Video->m_mode_log_count);
+	writer.write_bytes(Video->m_mode_log, Video->m_mode_log_count * sizeof(video_mode_change));
+	writer.write(Video->m_last_pass_modes);
+}
+
+void video_load_state(snapshot_reader &reader)
 {
-	// free the splash screen
-	// free the pixels used for the hires texture patterns
-	for (auto i = 0; i < Num_hires_mono_patterns; i++) {
-		delete Hires_mono_pixels[i];
+	uint64_t flash_cycle;
+
+	reader.read(Video->m_mode);
+	reader.read(Video->m_flash);
+	reader.read(flash_cycle);
+	reader.read(Video->m_pass_start_cycle);
+	reader.read(Video->m_pass_start_mode);
+	reader.read(Video->m_mode_log_count);
+	if (Video->m_mode_log_count > Video_max_mode_changes) {
+		reader.set_error();
+		Video->m_mode_log_count = 0;
 	}
-	delete Hires_color_pixels;
+	reader.read_bytes(Video->m_mode_log, Video->m_mode_log_count * sizeof(video_mode_change));
+	reader.read(Video->m_last_pass_modes);
+
+	scheduler_remove_event(video_flash_callback, nullptr);
+	scheduler_add_event(flash_cycle, video_flash_callback, nullptr);
+	video_invalidate();
+}
+
+void video_shutdown()
+{
 }
 
 bool Debug_show_bitmap = false;
 
 void video_set_tint(video_tint_types type)
 {
-	Video_tint_type = type;
-	Video_tint_color = Video_tint_colors[static_cast<uint8_t>(type)];
+	Video->m_tint_type = type;
 }
 
 GLfloat *video_get_tint(video_tint_types type)
 {
 	if (type == video_tint_types::TINT_TYPE_NONE) {
-		return Video_tint_color;
+		type = Video->m_tint_type;
 	}
 	return Video_tint_colors[static_cast<uint8_t>(type)];
 }
@@ -27,8 +27,14 @@ SOFTWARE.
 
 #pragma once
 
+#include <string>
+
 #include "SDL.h"
 #include "SDL_opengl.h"
+#include "apple2emu_defs.h"
+
+class snapshot_writer;
+class snapshot_reader;
 
 // video modes
 #define VIDEO_MODE_TEXT    (1 << 0)
@@ -37,6 +43,7 @@ SOFTWARE.
 #define VIDEO_MODE_HIRES   (1 << 3)
 #define VIDEO_MODE_80COL   (1 << 4)
 #define VIDEO_MODE_ALTCHAR (1 << 5)
+#define VIDEO_MODE_DHIRES  (1 << 6)
 
 // there is something weird with SDL/SDL_image
 // on mac (maybe linux) where textures are coming
@@ -62,18 +69,90 @@ enum class video_tint_types : uint8_t {
 	NUM_TINT_TYPES,
 };
 
+// counters for the framebuffer decode.  Counts are for the second in
+// progress and move to the last second once a second's worth of frames
+// have been rendered
+struct video_render_stats {
+	uint32_t m_frames;          // frames rendered
+	uint32_t m_frames_skipped;  // frames where nothing changed (no texture upload)
+	uint32_t m_lines;           // scanlines decoded
+};
+
+// always render to default size - SDL can scale it up
+// we use 560 here because of double hires (and 80 column
+// support.
+const int Video_native_width = 560;
+const int Video_native_height = 384;
+
+static const int Num_video_lines = 192;
+
+// video mode changes are logged against the beam position so that
+// programs that change modes partway down the screen are displayed
+// properly
+static const uint32_t Video_max_mode_changes = 256;
+
+struct video_mode_change {
+	uint32_t m_cycle;   // beam position of the change
+	uint8_t  m_mode;    // the new mode
+};
+
+// what each scanline was last decoded from, so that lines can be
+// skipped when nothing they show has changed
+struct video_line_state {
+	const uint8_t *m_src[2];   // memory for the line (aux and main for 80 column text)
+	uint8_t        m_mode;     // video mode the line was drawn in
+	bool           m_flashing; // line has flashing characters
+};
+
+// the display of one machine (see machine.h)
+struct video_state {
+	uint8_t            m_mode;        // VIDEO_MODE_* flags
+	bool               m_flash;       // flashing characters are showing inverse
+	video_tint_types   m_tint_type;
+
+	// the screen is decoded on the cpu side into this RGBA buffer, which
+	// is then uploaded as a single texture.  Pixels are packed as
+	// 0xAABBGGRR (upload with GL_UNSIGNED_INT_8_8_8_8_REV)
+	uint32_t           m_framebuffer[Video_native_width * Video_native_height];
+
+	video_mode_change  m_mode_log[Video_max_mode_changes];
+	uint32_t           m_mode_log_count;
+	uint64_t           m_pass_start_cycle;                // Total cycles at the start of the current pass
+	uint8_t            m_pass_start_mode;                 // mode at the start of the current pass
+	uint8_t            m_last_pass_modes[Num_video_lines]; // mode each line was drawn with in the last pass
+
+	video_line_state   m_line_states[Num_video_lines];
+
+	// state the framebuffer was last decoded with.  If any of this changes,
+	// every line is redrawn
+	bool               m_render_valid;
+	video_tint_types   m_render_tint;
+	const char        *m_render_conv_array;
+	bool               m_render_flash;
+
+	video_render_stats m_render_stats;
+	video_render_stats m_render_stats_last_second;
+};
+
+// display of the machine running on this thread
+extern THREAD_LOCAL video_state *Video;
+
 extern SDL_Renderer *Video_renderer;
-extern uint8_t Video_mode;
 extern SDL_Rect Video_window_size;
-extern const int Video_native_width;
-extern const int Video_native_height;
 
 bool video_init();
 void video_shutdown();
-void video_render_frame();
+bool video_render();
+void video_invalidate();
+const uint32_t *video_get_framebuffer();
+bool video_save_screenshot(const char *filename);
+std::string video_get_screen_text();
 void video_set_tint(video_tint_types type);
 GLfloat *video_get_tint(video_tint_types type = video_tint_types::TINT_TYPE_NONE);
 
 // called from soft switch reading/writing code in memory
-uint8_t video_set_state(uint16_t addr, uint8_t val, bool write);
-uint8_t video_get_state(uint16_t addr, uint8_t val, bool write);
+uint8_t video_soft_switch_read(void *context, uint16_t addr);
+void video_soft_switch_write(void *context, uint16_t addr, uint8_t val);
+uint8_t video_get_state(uint16_t addr);
+void video_save_state(snapshot_writer &writer);
+void video_load_state(snapshot_reader &reader);
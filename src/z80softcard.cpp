@@ -31,8 +31,11 @@ SOFTWARE.
  */
 
 #include "apple2emu_defs.h"
+#include "apple2emu.h"
+#include "machine.h"
 #include "z80softcard.h"
 #include "memory.h"
+#include "snapshot.h"
 #include "../z80emu/z80emu.h"
 
 /*
@@ -41,12 +44,7 @@ SOFTWARE.
  * the apple ][ emulator and the z80 emulator.
 */
 
-enum class z80_state {
-	WAIT,
-	ACTIVE,
-};
-
-static z80_state Z80_state;
+THREAD_LOCAL z80softcard_state *Z80softcard = nullptr;
 
 static bool Map_memory = true;
 
@@ -74,7 +72,7 @@ static uint16_t z80_map_z80_to_6502(uint16_t addr)
 
 int z80softcard_emulate(Z80_STATE *z80_cpu, int number_cycles)
 {
-	if (Z80_state == z80_state::WAIT) {
+	if (Z80softcard->m_state == z80_state::WAIT) {
 		return 0;
 	}
 	return Z80Emulate(z80_cpu, number_cycles, nullptr);
@@ -95,21 +93,27 @@ void z80_memory_write(uint16_t addr, uint8_t val)
 	memory_write(mapped_addr, val);
 }
 
-// handler for read/writes to z80 softcard space
-static uint8_t z80_handler(uint16_t addr, uint8_t val, bool write)
+// handler for writes to z80 softcard space.  The context is the
+// card state
+static void z80_handler(void *context, uint16_t addr, uint8_t val)
 {
 	UNREFERENCED(addr);
 	UNREFERENCED(val);
-	if (write) {
-		Z80_state = (Z80_state == z80_state::WAIT ? z80_state::ACTIVE : z80_state::WAIT);
-	}
-	return 255;
+	z80softcard_state *card = static_cast<z80softcard_state *>(context);
+	card->m_state = (card->m_state == z80_state::WAIT ? z80_state::ACTIVE : z80_state::WAIT);
+
+	// the 6502 needs to stop what it is running so that the
+	// main loop can switch processors
+	Machine->m_cpu.request_exit();
 }
 
 // initialize the z80 softward aystem
 void z80softcard_init()
 {
-	memory_register_slot_memory_handler(4, z80_handler);
+	slot_device z80_card = {};
+	z80_card.m_memory_write = z80_handler;
+	z80_card.m_context = Z80softcard;
+	memory_register_slot_handler(4, z80_card);
 }
 
 void z80softcard_reset(Z80_STATE *z80_cpu)
@@ -117,3 +121,34 @@ void z80softcard_reset(Z80_STATE *z80_cpu)
 	Z80Reset(z80_cpu);
 }
 
+// the card and the z80 registers.  The register decoding tables are
+// pointers into the z80 state, and are set up by the reset
+void z80softcard_save_state(snapshot_writer &writer)
+{
+	const Z80_STATE &z80 = Machine->m_z80_cpu;
+	writer.write(Z80softcard->m_state);
+	writer.write(z80.status);
+	writer.write(z80.registers);
+	writer.write(z80.alternates);
+	writer.write(z80.i);
+	writer.write(z80.r);
+	writer.write(z80.pc);
+	writer.write(z80.iff1);
+	writer.write(z80.iff2);
+	writer.write(z80.im);
+}
+
+void z80softcard_load_state(snapshot_reader &reader)
+{
+	Z80_STATE &z80 = Machine->m_z80_cpu;
+	reader.read(Z80softcard->m_state);
+	reader.read(z80.status);
+	reader.read(z80.registers);
+	reader.read(z80.alternates);
+	reader.read(z80.i);
+	reader.read(z80.r);
+	reader.read(z80.pc);
+	reader.read(z80.iff1);
+	reader.read(z80.iff2);
+	reader.read(z80.im);
+}
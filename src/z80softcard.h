@@ -28,8 +28,27 @@ SOFTWARE.
 #pragma once
 
 #include <stdint.h>
+#include "apple2emu_defs.h"
 #include "../z80emu/z80emu.h"
 
+class snapshot_writer;
+class snapshot_reader;
+
+enum class z80_state {
+	WAIT,
+	ACTIVE,
+};
+
+// the softcard in one machine (see machine.h)
+struct z80softcard_state {
+	z80_state m_state;   // the z80 runs instead of the 6502 while active
+};
+
+// softcard of the machine running on this thread
+extern THREAD_LOCAL z80softcard_state *Z80softcard;
+
 void z80softcard_init();
 void z80softcard_reset(Z80_STATE *z80_cpu);
 int z80softcard_emulate(Z80_STATE *z80_cpu, int number_cycles);
+void z80softcard_save_state(snapshot_writer &writer);
+void z80softcard_load_state(snapshot_reader &reader);